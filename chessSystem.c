@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "./mtm_map/map.h"
 #include "chess_utilities.h"
@@ -7,22 +8,69 @@
 #include "tournament.h"
 #include "player.h"
 #include "game.h"
+#include "chess_memory.h"
+#include "chess_batch.h"
+#include "chess_quantiles.h"
+#include "quantile_sketch.h"
+#include "chess_ranking.h"
+#include "ranking.h"
+#include "text_writer.h"
+#include "chess_snapshot.h"
+#include "snapshot.h"
 
 #define FAIL -1
 #define REMOVED_PLAYER -1
 #define WRITING_MODE "w"
+#define BINARY_WRITING_MODE "wb"
+#define MEDIAN 0.5
+#define PERCENTILE_90 0.9
+#define PERCENTILE_99 0.99
+#define TOURNAMENT_IDS_INITIAL_CAPACITY 4
 
-static void swap_int(int *element1, int *element2);
-static void swap_double(double *element1, double *element2);
-static bool bubble(double levels[], int ids[], int size);
-static void bubble_sort(double levels[], int ids[], int size);
-static Map chessFullPlayerMapCreate(ChessSystem chess, ChessResult *result);
-static ChessResult chessPrintPlayersLevels(Map full_players_data, FILE *file,
-                                             int *ids_array, double *levels_array, int size);
+static size_t chessPrintTournamentMemory(FILE *file, int tournament_id, Tournament tournament,
+                                         bool *failed);
+static void chessPrintPlayTimeQuantiles(TextWriter writer, QuantileSketch play_times);
+static ChessResult chessAddGameToTournament(ChessSystem chess, int tournament_id, Tournament tournament,
+                                            int first_player, int second_player, Winner winner, int play_time);
+static ChessResult chessCheckGameRecord(Tournament tournament, ChessResult tournament_result,
+                                       const GameRecord *record);
+static int chessMarkBatchDuplicates(const GameRecord *records, int n, const ChessResult *per_record,
+                                    int *first_of_pair);
+static bool chessReservePlayerTournament(ChessSystem chess, int player_id);
+static bool chessAddPlayerTournament(ChessSystem chess, int player_id, int tournament_id);
+static void chessRemovePlayerTournament(ChessSystem chess, int player_id, int tournament_id);
+static bool chessWriteSnapshot(ChessSystem chess, FILE *file);
+static ChessResult chessReadSnapshot(ChessSystem chess, SnapshotReader *reader);
+static ChessResult chessLinkLoadedTournament(ChessSystem chess, int tournament_id, Tournament tournament);
+
+/** The ids of the tournaments a player is in, in ascending order */
+typedef struct tournament_ids_t
+{
+    int *ids;
+    int size;
+    int capacity;
+} *TournamentIds;
+
+static TournamentIds tournamentIdsCreate(int capacity);
+static void tournamentIdsDestroy(TournamentIds tournament_ids);
+static TournamentIds tournamentIdsCopy(TournamentIds tournament_ids);
+static bool tournamentIdsReserve(TournamentIds tournament_ids, int size);
+static int tournamentIdsFind(TournamentIds tournament_ids, int tournament_id);
+
+/** Index from every player id to the ids of the tournaments whose players map holds the player */
+MAP_DEFINE(PlayerTournamentsIndex, playerTournamentsIndex, int, TournamentIds, tournamentIdsCopy,
+           tournamentIdsDestroy)
+static ChessResult chessPrintPlayersLevels(FILE *file, int *ids_array, double *levels_array, int size);
+
+/** The pairs of players of a batch given to chessAddGames, each with the first game of the pair */
+MAP_TABLE_DEFINE(BatchPairs, batchPairs, unsigned long long, int)
 
 struct chess_system_t
 {
     Map tournaments;
+    PlayerTournamentsIndex player_tournaments;
+    PlayerTotalsMap player_totals;
+    int ranking_workers;
 };
 
 ChessSystem chessCreate()
@@ -32,7 +80,15 @@ ChessSystem chessCreate()
     {
         return NULL;
     }
-    chess->tournaments = mapCreate(copyDataTournament, copyKeyInt, freeTournament, freeInt, compareInts);
+    chess->tournaments = mapCreateInt(copyDataTournament, freeTournament);
+    chess->player_tournaments = playerTournamentsIndexCreate();
+    chess->player_totals = playerTotalsMapCreate();
+    chess->ranking_workers = 1;
+    if (chess->tournaments == NULL || chess->player_tournaments == NULL || chess->player_totals == NULL)
+    {
+        chessDestroy(chess);
+        return NULL;
+    }
     return chess;
 }
 
@@ -41,10 +97,198 @@ void chessDestroy(ChessSystem chess)
     if (chess != NULL)
     {
         mapDestroy(chess->tournaments);
+        playerTournamentsIndexDestroy(chess->player_tournaments);
+        playerTotalsMapDestroy(chess->player_totals);
         free(chess);
     }
 }
 
+TournamentIds tournamentIdsCreate(int capacity)
+{
+    TournamentIds tournament_ids = malloc(sizeof(*tournament_ids));
+    if (tournament_ids == NULL)
+    {
+        return NULL;
+    }
+    tournament_ids->ids = malloc(sizeof(*tournament_ids->ids) * capacity);
+    if (tournament_ids->ids == NULL)
+    {
+        free(tournament_ids);
+        return NULL;
+    }
+    tournament_ids->size = 0;
+    tournament_ids->capacity = capacity;
+    return tournament_ids;
+}
+
+void tournamentIdsDestroy(TournamentIds tournament_ids)
+{
+    if (tournament_ids != NULL)
+    {
+        free(tournament_ids->ids);
+        free(tournament_ids);
+    }
+}
+
+TournamentIds tournamentIdsCopy(TournamentIds tournament_ids)
+{
+    TournamentIds new_tournament_ids = tournamentIdsCreate(tournament_ids->capacity);
+    if (new_tournament_ids == NULL)
+    {
+        return NULL;
+    }
+    memcpy(new_tournament_ids->ids, tournament_ids->ids, sizeof(*tournament_ids->ids) * tournament_ids->size);
+    new_tournament_ids->size = tournament_ids->size;
+    return new_tournament_ids;
+}
+
+bool tournamentIdsReserve(TournamentIds tournament_ids, int size)
+{
+    if (size <= tournament_ids->capacity)
+    {
+        return true;
+    }
+    int *ids = realloc(tournament_ids->ids, sizeof(*ids) * tournament_ids->capacity * 2);
+    if (ids == NULL)
+    {
+        return false;
+    }
+    tournament_ids->ids = ids;
+    tournament_ids->capacity *= 2;
+    return true;
+}
+
+/** Returns the position of a tournament id, or the position it would be inserted at */
+int tournamentIdsFind(TournamentIds tournament_ids, int tournament_id)
+{
+    int low = 0, high = tournament_ids->size;
+    while (low < high)
+    {
+        int middle = low + (high - low) / 2;
+        if (tournament_ids->ids[middle] < tournament_id)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/** Makes sure the player has totals and adding a tournament to the player cannot fail */
+bool chessReservePlayerTournament(ChessSystem chess, int player_id)
+{
+    if (!playerTotalsMapContains(chess->player_totals, player_id))
+    {
+        PlayerTotals totals = playerTotalsCreate();
+        if (totals == NULL)
+        {
+            return false;
+        }
+        if (playerTotalsMapPut(chess->player_totals, player_id, totals) != MAP_SUCCESS)
+        {
+            playerTotalsDestroy(totals);
+            return false;
+        }
+    }
+    TournamentIds tournament_ids = playerTournamentsIndexGet(chess->player_tournaments, player_id);
+    if (tournament_ids == NULL)
+    {
+        tournament_ids = tournamentIdsCreate(TOURNAMENT_IDS_INITIAL_CAPACITY);
+        if (tournament_ids == NULL)
+        {
+            return false;
+        }
+        if (playerTournamentsIndexPut(chess->player_tournaments, player_id, tournament_ids) != MAP_SUCCESS)
+        {
+            tournamentIdsDestroy(tournament_ids);
+            return false;
+        }
+    }
+    return tournamentIdsReserve(tournament_ids, tournament_ids->size + 1);
+}
+
+/**
+ * Adds a tournament to a player reserved by chessReservePlayerTournament.
+ * Returns false if the tournament was there already.
+ */
+bool chessAddPlayerTournament(ChessSystem chess, int player_id, int tournament_id)
+{
+    TournamentIds tournament_ids = playerTournamentsIndexGet(chess->player_tournaments, player_id);
+    int position = tournamentIdsFind(tournament_ids, tournament_id);
+    if (position < tournament_ids->size && tournament_ids->ids[position] == tournament_id)
+    {
+        return false;
+    }
+    memmove(tournament_ids->ids + position + 1, tournament_ids->ids + position,
+            sizeof(*tournament_ids->ids) * (tournament_ids->size - position));
+    tournament_ids->ids[position] = tournament_id;
+    tournament_ids->size++;
+    return true;
+}
+
+/** Removes a tournament from a player, and the player from the index and the totals once it has no tournaments */
+void chessRemovePlayerTournament(ChessSystem chess, int player_id, int tournament_id)
+{
+    TournamentIds tournament_ids = playerTournamentsIndexGet(chess->player_tournaments, player_id);
+    if (tournament_ids == NULL)
+    {
+        return;
+    }
+    int position = tournamentIdsFind(tournament_ids, tournament_id);
+    if (position < tournament_ids->size && tournament_ids->ids[position] == tournament_id)
+    {
+        memmove(tournament_ids->ids + position, tournament_ids->ids + position + 1,
+                sizeof(*tournament_ids->ids) * (tournament_ids->size - position - 1));
+        tournament_ids->size--;
+    }
+    if (tournament_ids->size == 0)
+    {
+        playerTournamentsIndexRemove(chess->player_tournaments, player_id);
+        playerTotalsMapRemove(chess->player_totals, player_id);
+    }
+}
+
+/**
+ * Adds a game to a tournament which has not ended, and the tournament to the index of its players.
+ * The stats of both players in the tournament are taken off their totals before the game and added
+ * back after it, so the totals change by what the game changed.
+ */
+ChessResult chessAddGameToTournament(ChessSystem chess, int tournament_id, Tournament tournament,
+                                     int first_player, int second_player, Winner winner, int play_time)
+{
+    ChessResult result = CHESS_OUT_OF_MEMORY;
+    int players[] = {first_player, second_player};
+    if (chessReservePlayerTournament(chess, first_player) && chessReservePlayerTournament(chess, second_player))
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            playerTotalsRemove(playerTotalsMapGet(chess->player_totals, players[i]),
+                               tournamentGetPlayer(tournament, players[i]));
+        }
+        result = tournamentAddGame(tournament, first_player, second_player, winner, play_time);
+        for (int i = 0; i < 2; i++)
+        {
+            playerTotalsAdd(playerTotalsMapGet(chess->player_totals, players[i]),
+                            tournamentGetPlayer(tournament, players[i]));
+        }
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        if (tournamentGetPlayer(tournament, players[i]) != NULL)
+        {
+            chessAddPlayerTournament(chess, players[i], tournament_id);
+        }
+        else
+        {
+            chessRemovePlayerTournament(chess, players[i], tournament_id);
+        }
+    }
+    return result;
+}
+
 ChessResult chessAddTournament(ChessSystem chess, int tournament_id,
                                int max_games_per_player, const char *tournament_location)
 {
@@ -64,11 +308,11 @@ ChessResult chessAddTournament(ChessSystem chess, int tournament_id,
     Tournament temp_tournament = createTournament(max_games_per_player, tournament_location, &result);
     if (result == CHESS_SUCCESS)
     {
-        MapResult map_result = mapPut(chess->tournaments, (MapKeyElement)(&tournament_id),
-                                     (MapDataElement)temp_tournament);
-        destroyTournament(temp_tournament);
+        MapResult map_result = mapPutTake(chess->tournaments, (MapKeyElement)(&tournament_id),
+                                         (MapDataElement)temp_tournament);
         if (map_result == MAP_OUT_OF_MEMORY)
         {
+            destroyTournament(temp_tournament);
             return CHESS_OUT_OF_MEMORY;
         }
     }
@@ -91,7 +335,133 @@ ChessResult chessAddGame(ChessSystem chess, int tournament_id, int first_player,
     {
         return CHESS_TOURNAMENT_ENDED;
     }
-    ChessResult result = tournamentAddGame(current_tournament, first_player, second_player, winner, play_time);
+    ChessResult result = chessAddGameToTournament(chess, tournament_id, current_tournament,
+                                                  first_player, second_player, winner, play_time);
+    return result;
+}
+
+/**
+ * Returns the result chessAddGame gives a game whatever the games added before it, or CHESS_SUCCESS
+ * if the game may still be added.
+ */
+ChessResult chessCheckGameRecord(Tournament tournament, ChessResult tournament_result, const GameRecord *record)
+{
+    if (record->first_player <= 0 || record->second_player <= 0 || record->first_player == record->second_player)
+    {
+        return CHESS_INVALID_ID;
+    }
+    if (tournament_result != CHESS_SUCCESS)
+    {
+        return tournament_result;
+    }
+    return tournamentCheckForAddGame(tournament, record->first_player, record->second_player,
+                                     record->winner, record->play_time);
+}
+
+/**
+ * Sets first_of_pair[i] to the index of the first game of the batch between the players of game i,
+ * if it is an earlier one, and to -1 otherwise. Only the games whose result is still CHESS_SUCCESS
+ * count, except those with a negative play time, which are never added.
+ * Returns the number of games left to add once the repeated pairs are dropped, -1 if an allocation failed.
+ */
+int chessMarkBatchDuplicates(const GameRecord *records, int n, const ChessResult *per_record, int *first_of_pair)
+{
+    BatchPairs pairs = batchPairsCreate();
+    if (pairs == NULL || batchPairsReserve(pairs, n) != MAP_SUCCESS)
+    {
+        batchPairsDestroy(pairs);
+        return FAIL;
+    }
+    int count = 0;
+    for (int i = 0; i < n; i++)
+    {
+        first_of_pair[i] = FAIL;
+        if (per_record[i] != CHESS_SUCCESS || records[i].play_time < 0)
+        {
+            continue;
+        }
+        unsigned long long pair = tournamentPairKey(records[i].first_player, records[i].second_player);
+        int slot = batchPairsProbe(pairs, pair);
+        if (pairs->slots[slot].order != 0)
+        {
+            first_of_pair[i] = pairs->slots[slot].value;
+            continue;
+        }
+        batchPairsInsertAt(pairs, slot, pair, i);
+        count++;
+    }
+    batchPairsDestroy(pairs);
+    return count;
+}
+
+ChessResult chessAddGames(ChessSystem chess, int tournament_id, const GameRecord *records, int n,
+                          ChessResult *per_record)
+{
+    if (!chess || (n > 0 && (!records || !per_record)))
+    {
+        return CHESS_NULL_ARGUMENT;
+    }
+    Tournament current_tournament = NULL;
+    ChessResult tournament_result = CHESS_INVALID_ID;
+    if (tournament_id > 0)
+    {
+        current_tournament = mapGet(chess->tournaments, (MapKeyElement)(&tournament_id));
+        if (current_tournament == NULL)
+        {
+            tournament_result = CHESS_TOURNAMENT_NOT_EXIST;
+        }
+        else if (tournamentHasEnded(current_tournament))
+        {
+            tournament_result = CHESS_TOURNAMENT_ENDED;
+        }
+        else
+        {
+            tournament_result = CHESS_SUCCESS;
+        }
+    }
+    for (int i = 0; i < n; i++)
+    {
+        per_record[i] = chessCheckGameRecord(current_tournament, tournament_result, records + i);
+    }
+    int *first_of_pair = NULL;
+    if (tournament_result == CHESS_SUCCESS && n > 0)
+    {
+        first_of_pair = malloc(sizeof(*first_of_pair) * n);
+        int count = first_of_pair == NULL ? FAIL
+                                          : chessMarkBatchDuplicates(records, n, per_record, first_of_pair);
+        if (count == FAIL || !tournamentReserveGames(current_tournament, count))
+        {
+            free(first_of_pair);
+            first_of_pair = NULL;
+            for (int i = 0; i < n; i++)
+            {
+                per_record[i] = per_record[i] == CHESS_SUCCESS ? CHESS_OUT_OF_MEMORY : per_record[i];
+            }
+        }
+    }
+    ChessResult result = CHESS_SUCCESS;
+    for (int i = 0; i < n; i++)
+    {
+        if (per_record[i] == CHESS_SUCCESS)
+        {
+            const GameRecord *record = records + i;
+            if (first_of_pair[i] != FAIL && per_record[first_of_pair[i]] == CHESS_SUCCESS)
+            {
+                per_record[i] = CHESS_GAME_ALREADY_EXISTS;
+            }
+            else
+            {
+                per_record[i] = chessAddGameToTournament(chess, tournament_id, current_tournament,
+                                                         record->first_player, record->second_player,
+                                                         record->winner, record->play_time);
+            }
+        }
+        if (result == CHESS_SUCCESS)
+        {
+            result = per_record[i];
+        }
+    }
+    free(first_of_pair);
     return result;
 }
 
@@ -101,10 +471,18 @@ ChessResult chessRemoveTournament(ChessSystem chess, int tournament_id)
     {
         return CHESS_INVALID_ID;
     }
-    if (!mapContains(chess->tournaments, (MapKeyElement)(&tournament_id)))
+    Tournament tournament = mapGet(chess->tournaments, (MapKeyElement)(&tournament_id));
+    if (tournament == NULL)
     {
         return CHESS_TOURNAMENT_NOT_EXIST;
     }
+    MAP_DEFINE_FOREACH(PlayerMap, playerMap, player_cursor, tournamentGetPlayersMap(tournament))
+    {
+        int player_id = playerMapCursorGetKey(&player_cursor);
+        playerTotalsRemove(playerTotalsMapGet(chess->player_totals, player_id),
+                           playerMapCursorGetData(&player_cursor));
+        chessRemovePlayerTournament(chess, player_id, tournament_id);
+    }
     MapResult result = mapRemove(chess->tournaments, (MapKeyElement)(&tournament_id));
     if (result != MAP_SUCCESS)
     {
@@ -124,47 +502,27 @@ ChessResult chessRemovePlayer(ChessSystem chess, int player_id)
     {
         return CHESS_INVALID_ID;
     }
-    for (int *current = mapGetFirst(chess->tournaments); current; current = mapGetNext(chess->tournaments))
+    TournamentIds tournament_ids = playerTournamentsIndexGet(chess->player_tournaments, player_id);
+    for (int i = 0; tournament_ids != NULL && i < tournament_ids->size; i++)
     {
-        Tournament tournament = mapGet(chess->tournaments, (MapKeyElement)(current));
-        if (!tournament)
+        Tournament tournament = mapGet(chess->tournaments, (MapKeyElement)(tournament_ids->ids + i));
+        Player player = tournamentGetPlayer(tournament, player_id);
+        if (player == NULL || playerGetGames(player) == 0)
         {
-            free(current);
-            return CHESS_TOURNAMENT_NOT_EXIST;
+            continue;
         }
-        Map players = tournamentGetPlayersMap(tournament);
-        if (mapContains(players, (MapKeyElement)(&player_id)))
+        player_exist = true;
+        if (tournamentHasEnded(tournament))
         {
-            Player player = mapGet(players, (MapKeyElement)(&player_id));
-            if (playerGetGames(player) == 0)
-            {
-                free(current);
-                continue;
-            }
-            player_exist = true;
-            if (tournamentHasEnded(tournament))
-            {   
-                playerReset(player);
-                free(current);
-                continue;
-            }
-            ChessResult result = tournamentRemovePlayer(tournament,player, player_id);
-            if (result != CHESS_SUCCESS)
-            {
-                free(current);
-                if (result == CHESS_PLAYER_NOT_EXIST)
-                {
-                    continue;
-                }
-                return result;
-            }
+            playerTotalsRemove(playerTotalsMapGet(chess->player_totals, player_id), player);
+            playerReset(player);
+            continue;
         }
-        else
+        ChessResult result = tournamentRemovePlayer(tournament, player, player_id, chess->player_totals);
+        if (result != CHESS_SUCCESS && result != CHESS_PLAYER_NOT_EXIST)
         {
-            free(current);
-            continue;
+            return result;
         }
-        free(current);
     }
     if (player_exist == false)
     {
@@ -204,24 +562,17 @@ double chessCalculateAveragePlayTime(ChessSystem chess, int player_id, ChessResu
         return FAIL;
     }
     int sum_time = 0, sum_games = 0;
-    for (int *current = mapGetFirst(chess->tournaments); current; current = mapGetNext(chess->tournaments))
+    TournamentIds tournament_ids = playerTournamentsIndexGet(chess->player_tournaments, player_id);
+    for (int i = 0; tournament_ids != NULL && i < tournament_ids->size; i++)
     {
-        Tournament tournament = mapGet(chess->tournaments, (MapKeyElement)(current));
-        if (!tournament)
-        {
-            *chess_result = CHESS_TOURNAMENT_NOT_EXIST;
-            free(current);
-            return FAIL;
-        }
+        Tournament tournament = mapGet(chess->tournaments, (MapKeyElement)(tournament_ids->ids + i));
         Player player = tournamentGetPlayer(tournament, player_id);
         if (!player)
         {
-            free(current);
             continue;
         }
         sum_time += playerGetPlayTime(player);
         sum_games += playerGetGames(player);
-        free(current);
     }
     if (sum_games == 0)
     {
@@ -232,102 +583,35 @@ double chessCalculateAveragePlayTime(ChessSystem chess, int player_id, ChessResu
     return (double)sum_time / (double)sum_games;
 }
 
-void swap_int(int *element1, int *element2)
-{
-    int temp = *element1;
-    *element1 = *element2;
-    *element2 = temp;
-}
-
-void swap_double(double *element1, double *element2)
+ChessResult chessPrintPlayersLevels(FILE *file, int* ids_array, double* levels_array, int size)
 {
-    double temp = *element1;
-    *element1 = *element2;
-    *element2 = temp;
-}
-
-bool bubble(double levels[], int ids[], int size)
-{
-    bool swapped = false;
-    for (int i = 1; i < size; i++)
-        if ((levels[i - 1] < levels[i]) || ((levels[i - 1] == levels[i]) && (ids[i - 1] > ids[i])))
+    TextWriter writer = textWriterCreate(file);
+    for (int i = 0; writer != NULL && i < size; i++)
+    {
+        if (levels_array[i] != REMOVED_PLAYER)
         {
-            swap_double(&levels[i], &levels[i - 1]);
-            swap_int(&ids[i], &ids[i - 1]);
-            swapped = true;
+            textWriterInt(writer, ids_array[i]);
+            textWriterChar(writer, ' ');
+            textWriterFixed(writer, levels_array[i]);
+            textWriterChar(writer, '\n');
         }
-    return swapped;
-}
-
-void bubble_sort(double levels[], int ids[], int size)
-{
-    bool not_sorted = true;
-    while (size > 1 && not_sorted)
-    {
-        not_sorted = bubble(levels, ids, size);
-        size--;
     }
-}
-
-Map chessFullPlayerMapCreate(ChessSystem chess, ChessResult* result)
-{
-    Map full_players_data = mapCreate(copyDataPlayer, copyKeyInt, freePlayer, freeInt, compareInts);
-    for (MapKeyElement current_tournament_key = mapGetFirst(chess->tournaments);
-         current_tournament_key; current_tournament_key = mapGetNext(chess->tournaments))
+    if (!textWriterDestroy(writer))
     {
-        Tournament current_tournament = mapGet(chess->tournaments, current_tournament_key);
-        if (current_tournament != NULL)
-        {
-            Map current_players_map = tournamentGetPlayersMap(current_tournament);
-            for (MapKeyElement current_player_key = mapGetFirst(current_players_map);
-                 current_player_key; current_player_key = mapGetNext(current_players_map))
-            {
-                Player current_player = mapGet(current_players_map, current_player_key);
-                if (!mapContains(full_players_data, current_player_key))
-                {
-                    if (mapPut(full_players_data, current_player_key, (MapDataElement)(current_player)) !=
-                            MAP_SUCCESS)
-                    {
-                        free(current_tournament_key);
-                        free(current_player_key);
-                        mapDestroy(full_players_data);
-                        *result = CHESS_SAVE_FAILURE;
-                        return NULL;
-                    }
-                }
-                else
-                {
-                    Player current_full_player = mapGet(full_players_data, current_player_key);
-                    playerAddWins(current_full_player, playerGetWins(current_player));
-                    playerAddLoses(current_full_player, playerGetLoses(current_player));
-                    playerAddDraws(current_full_player, playerGetDraws(current_player));
-                    playerAddGamesPlayed(current_full_player, playerGetGames(current_player));
-                    playerAddTimePlayed(current_full_player, playerGetPlayTime(current_player));
-                }
-                free(current_player_key);
-            }
-        }
-        free(current_tournament_key);
+        free(levels_array);
+        free(ids_array);
+        return CHESS_SAVE_FAILURE;
     }
-    return full_players_data;
+    return CHESS_SUCCESS;
 }
 
-ChessResult chessPrintPlayersLevels(Map full_players_data, FILE *file, int* ids_array, double* levels_array, int size)
+ChessResult chessSetRankingWorkers(ChessSystem chess, int workers)
 {
-    for (int i = 0; i < size; i++)
+    if (chess == NULL)
     {
-        if (levels_array[i] != REMOVED_PLAYER)
-        {
-            int result = fprintf(file, "%d %.2lf\n", ids_array[i], levels_array[i]);
-            if (result < 0)
-            {
-                free(levels_array);
-                free(ids_array);
-                mapDestroy(full_players_data);
-                return CHESS_SAVE_FAILURE;
-            }
-        }
+        return CHESS_NULL_ARGUMENT;
     }
+    chess->ranking_workers = workers < 1 ? 1 : workers;
     return CHESS_SUCCESS;
 }
 
@@ -337,60 +621,46 @@ ChessResult chessSavePlayersLevels(ChessSystem chess, FILE *file)
     {
         return CHESS_NULL_ARGUMENT;
     }
-    ChessResult result;
-    Map full_players_data = chessFullPlayerMapCreate(chess,&result);
-    if(!full_players_data)
-    {
-        return result;
-    }
-    int size = mapGetSize(full_players_data), i = 0;
+    int size = playerTotalsMapGetSize(chess->player_totals), i = 0;
     double *levels_array = malloc(sizeof(*levels_array) * size);
     int *ids_array = malloc(sizeof(*ids_array) * size);
     if (!levels_array)
     {
-        mapDestroy(full_players_data);
         return CHESS_SAVE_FAILURE;
     }
     if (!ids_array)
     {
         free(levels_array);
-        mapDestroy(full_players_data);
         return CHESS_SAVE_FAILURE;
     }
-    for (MapKeyElement current_player_key = mapGetFirst(full_players_data);
-         current_player_key; current_player_key = mapGetNext(full_players_data))
+    MAP_DEFINE_FOREACH(PlayerTotalsMap, playerTotalsMap, cursor, chess->player_totals)
     {
-        Player current_player = mapGet(full_players_data, current_player_key);
-        if (current_player == NULL)
-        {
-            free(levels_array);
-            free(ids_array);
-            free(current_player_key);
-            mapDestroy(full_players_data);
-            return CHESS_SAVE_FAILURE;
-        }
-        int player_games = playerGetGames(current_player);
+        PlayerTotals totals = playerTotalsMapCursorGetData(&cursor);
+        int player_games = playerTotalsGetGames(totals);
         if (player_games == 0)
         {
             levels_array[i] = REMOVED_PLAYER;
         }
         else
         {
-            levels_array[i] = (double)playerGetLevel(current_player) / (double)player_games;
+            levels_array[i] = (double)playerTotalsGetLevel(totals) / (double)player_games;
         }
-        ids_array[i] = *((int *)current_player_key);
+        ids_array[i] = playerTotalsMapCursorGetKey(&cursor);
         i++;
-        free(current_player_key);
     }
-    bubble_sort(levels_array, ids_array, size);
-    result = chessPrintPlayersLevels(full_players_data,file,ids_array,levels_array,size);
+    if (!rankingSort(levels_array, ids_array, size, chess->ranking_workers))
+    {
+        free(levels_array);
+        free(ids_array);
+        return CHESS_SAVE_FAILURE;
+    }
+    ChessResult result = chessPrintPlayersLevels(file,ids_array,levels_array,size);
     if(result != CHESS_SUCCESS)
     {
         return result;
     }
     free(levels_array);
     free(ids_array);
-    mapDestroy(full_players_data);
     return CHESS_SUCCESS;
 }
 
@@ -406,29 +676,26 @@ ChessResult chessSaveTournamentStatistics(ChessSystem chess, char *path_file)
     {
         return CHESS_SAVE_FAILURE;
     }
-    for (int *current = mapGetFirst(chess->tournaments); current; current = mapGetNext(chess->tournaments))
+    TextWriter writer = textWriterCreate(file);
+    if (!writer)
     {
-        Tournament tournament = mapGet(chess->tournaments, (MapKeyElement)(current));
-        if (!tournament)
-        {
-            free(current);
-            fclose(file);
-            return CHESS_SAVE_FAILURE;
-        }
+        fclose(file);
+        return CHESS_SAVE_FAILURE;
+    }
+    MAP_CURSOR_FOREACH(cursor, chess->tournaments)
+    {
+        Tournament tournament = mapCursorGetData(&cursor);
         if (!tournamentHasEnded(tournament))
         {
-            free(current);
             continue;
         }
         no_tournaments_ended = false;
-        ChessResult result = printTournamentStatistics(file, tournament);
-        if (result != CHESS_SUCCESS)
-        {
-            free(current);
-            fclose(file);
-            return CHESS_SAVE_FAILURE;
-        }
-        free(current);
+        printTournamentStatistics(writer, tournament);
+    }
+    if (!textWriterDestroy(writer))
+    {
+        fclose(file);
+        return CHESS_SAVE_FAILURE;
     }
     fclose(file);
     if (no_tournaments_ended)
@@ -437,3 +704,231 @@ ChessResult chessSaveTournamentStatistics(ChessSystem chess, char *path_file)
     }
     return CHESS_SUCCESS;
 }
+
+/** Prints the memory line of a tournament and returns its total */
+size_t chessPrintTournamentMemory(FILE *file, int tournament_id, Tournament tournament, bool *failed)
+{
+    ChessMemoryUsage usage;
+    tournamentMemoryUsage(tournament, &usage);
+    size_t total = usage.tournament + usage.location + usage.games_map + usage.games +
+                   usage.players_map + usage.players;
+    int result = fprintf(file, "tournament %d: %zu bytes (structure %zu, location %zu, games map %zu, "
+                         "%d games %zu, players map %zu, %d players %zu)\n",
+                         tournament_id, total, usage.tournament, usage.location, usage.games_map,
+                         usage.games_count, usage.games, usage.players_map,
+                         usage.players_count, usage.players);
+    if (result < 0)
+    {
+        *failed = true;
+    }
+    return total;
+}
+
+ChessResult chessMemoryReport(ChessSystem chess, FILE *file)
+{
+    if (chess == NULL || file == NULL)
+    {
+        return CHESS_NULL_ARGUMENT;
+    }
+    bool failed = false;
+    size_t tournaments = 0;
+    MAP_CURSOR_FOREACH(cursor, chess->tournaments)
+    {
+        tournaments += chessPrintTournamentMemory(file, *(int *)mapCursorGetKey(&cursor),
+                                                  mapCursorGetData(&cursor), &failed);
+    }
+    MapMemoryUsage map_usage;
+    mapMemoryUsage(chess->tournaments, NULL, NULL, &map_usage);
+    size_t tournaments_map = map_usage.structure + map_usage.nodes + map_usage.keys;
+    size_t structure = sizeof(*chess) + playerTournamentsIndexMemoryUsage(chess->player_tournaments) +
+                       playerTotalsMapMemoryUsage(chess->player_totals);
+    MAP_DEFINE_FOREACH(PlayerTournamentsIndex, playerTournamentsIndex, index_cursor, chess->player_tournaments)
+    {
+        TournamentIds tournament_ids = playerTournamentsIndexCursorGetData(&index_cursor);
+        structure += sizeof(*tournament_ids) + sizeof(*tournament_ids->ids) * tournament_ids->capacity;
+    }
+    MAP_DEFINE_FOREACH(PlayerTotalsMap, playerTotalsMap, totals_cursor, chess->player_totals)
+    {
+        structure += playerTotalsMemoryUsage(playerTotalsMapCursorGetData(&totals_cursor));
+    }
+    size_t total = structure + tournaments_map + tournaments;
+    int result = fprintf(file, "system: %zu bytes (structure %zu, tournaments map %zu, %d tournaments %zu)\n",
+                         total, structure, tournaments_map, mapGetSize(chess->tournaments), tournaments);
+    if (failed || result < 0)
+    {
+        return CHESS_SAVE_FAILURE;
+    }
+    return CHESS_SUCCESS;
+}
+
+/** Prints the count and the percentiles of a sketch, ending the line */
+void chessPrintPlayTimeQuantiles(TextWriter writer, QuantileSketch play_times)
+{
+    textWriterInt(writer, quantileSketchGetCount(play_times));
+    textWriterString(writer, " games, p50 ");
+    textWriterInt(writer, quantileSketchGetQuantile(play_times, MEDIAN));
+    textWriterString(writer, ", p90 ");
+    textWriterInt(writer, quantileSketchGetQuantile(play_times, PERCENTILE_90));
+    textWriterString(writer, ", p99 ");
+    textWriterInt(writer, quantileSketchGetQuantile(play_times, PERCENTILE_99));
+    textWriterChar(writer, '\n');
+}
+
+ChessResult chessSavePlayTimeQuantiles(ChessSystem chess, FILE *file)
+{
+    if (chess == NULL || file == NULL)
+    {
+        return CHESS_NULL_ARGUMENT;
+    }
+    QuantileSketch all_play_times = quantileSketchCreate();
+    TextWriter writer = textWriterCreate(file);
+    if (all_play_times == NULL || writer == NULL)
+    {
+        quantileSketchDestroy(all_play_times);
+        textWriterDestroy(writer);
+        return CHESS_OUT_OF_MEMORY;
+    }
+    MAP_CURSOR_FOREACH(cursor, chess->tournaments)
+    {
+        QuantileSketch play_times = tournamentGetPlayTimes(mapCursorGetData(&cursor));
+        if (quantileSketchGetCount(play_times) == 0)
+        {
+            continue;
+        }
+        quantileSketchMerge(all_play_times, play_times);
+        textWriterString(writer, "tournament ");
+        textWriterInt(writer, *(int *)mapCursorGetKey(&cursor));
+        textWriterString(writer, ": ");
+        chessPrintPlayTimeQuantiles(writer, play_times);
+    }
+    textWriterString(writer, "system: ");
+    chessPrintPlayTimeQuantiles(writer, all_play_times);
+    quantileSketchDestroy(all_play_times);
+    return textWriterDestroy(writer) ? CHESS_SUCCESS : CHESS_SAVE_FAILURE;
+}
+
+/** Writes the header, the tournaments count and every tournament with its id */
+bool chessWriteSnapshot(ChessSystem chess, FILE *file)
+{
+    int tournaments_count = mapGetSize(chess->tournaments);
+    if (!snapshotWriteHeader(file) || !snapshotWriteInts(file, &tournaments_count, 1))
+    {
+        return false;
+    }
+    MAP_CURSOR_FOREACH(cursor, chess->tournaments)
+    {
+        if (!snapshotWriteInts(file, (int *)mapCursorGetKey(&cursor), 1) ||
+            !tournamentSaveSnapshot(mapCursorGetData(&cursor), file))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+ChessResult chessSaveSnapshot(ChessSystem chess, const char *path)
+{
+    if (chess == NULL || path == NULL)
+    {
+        return CHESS_NULL_ARGUMENT;
+    }
+    FILE *file = fopen(path, BINARY_WRITING_MODE);
+    if (file == NULL)
+    {
+        return CHESS_SAVE_FAILURE;
+    }
+    bool written = chessWriteSnapshot(chess, file);
+    if (fclose(file) != 0 || !written)
+    {
+        return CHESS_SAVE_FAILURE;
+    }
+    return CHESS_SUCCESS;
+}
+
+/** Adds a loaded tournament to the index of its players and its stats to their totals */
+ChessResult chessLinkLoadedTournament(ChessSystem chess, int tournament_id, Tournament tournament)
+{
+    MAP_DEFINE_FOREACH(PlayerMap, playerMap, cursor, tournamentGetPlayersMap(tournament))
+    {
+        int player_id = playerMapCursorGetKey(&cursor);
+        if (!chessReservePlayerTournament(chess, player_id))
+        {
+            return CHESS_OUT_OF_MEMORY;
+        }
+        if (chessAddPlayerTournament(chess, player_id, tournament_id))
+        {
+            playerTotalsAdd(playerTotalsMapGet(chess->player_totals, player_id), playerMapCursorGetData(&cursor));
+        }
+    }
+    return CHESS_SUCCESS;
+}
+
+/**
+ * Reads the tournaments of a snapshot into an empty chess system. They come in
+ * ascending id order, so the tournaments map and the player index are built
+ * by appending, without moving what is already there.
+ */
+ChessResult chessReadSnapshot(ChessSystem chess, SnapshotReader *reader)
+{
+    int tournaments_count;
+    if (!snapshotReadInts(reader, &tournaments_count, 1) || tournaments_count < 0)
+    {
+        return CHESS_SAVE_FAILURE;
+    }
+    int previous_id = 0;
+    for (int i = 0; i < tournaments_count; i++)
+    {
+        int tournament_id;
+        if (!snapshotReadInts(reader, &tournament_id, 1) || tournament_id <= previous_id)
+        {
+            return CHESS_SAVE_FAILURE;
+        }
+        previous_id = tournament_id;
+        ChessResult result;
+        Tournament tournament = tournamentLoadSnapshot(reader, &result);
+        if (tournament == NULL)
+        {
+            return result;
+        }
+        if (mapPutTake(chess->tournaments, (MapKeyElement)(&tournament_id),
+                       (MapDataElement)tournament) != MAP_SUCCESS)
+        {
+            destroyTournament(tournament);
+            return CHESS_OUT_OF_MEMORY;
+        }
+        result = chessLinkLoadedTournament(chess, tournament_id, tournament);
+        if (result != CHESS_SUCCESS)
+        {
+            return result;
+        }
+    }
+    return reader->position == reader->end ? CHESS_SUCCESS : CHESS_SAVE_FAILURE;
+}
+
+ChessSystem chessLoadSnapshot(const char *path, ChessResult *result)
+{
+    if (result == NULL)
+    {
+        return NULL;
+    }
+    if (path == NULL)
+    {
+        *result = CHESS_NULL_ARGUMENT;
+        return NULL;
+    }
+    SnapshotReader reader;
+    if (!snapshotReaderOpen(&reader, path))
+    {
+        *result = CHESS_SAVE_FAILURE;
+        return NULL;
+    }
+    ChessSystem chess = chessCreate();
+    *result = chess == NULL ? CHESS_OUT_OF_MEMORY : chessReadSnapshot(chess, &reader);
+    snapshotReaderClose(&reader);
+    if (*result != CHESS_SUCCESS)
+    {
+        chessDestroy(chess);
+        return NULL;
+    }
+    return chess;
+}
@@ -0,0 +1,40 @@
+#ifndef CHESS_BATCH_H_
+#define CHESS_BATCH_H_
+
+#include "chessSystem.h"
+
+/** One game of a batch given to chessAddGames, with the arguments of chessAddGame */
+typedef struct GameRecord_t
+{
+    int first_player;
+    int second_player;
+    Winner winner;
+    int play_time;
+} GameRecord;
+
+/**
+* chessAddGames: adds a batch of games to a tournament. The tournament is
+* looked up once and every game is checked before any is added: games with
+* invalid arguments, games between players who already met in the tournament
+* and games repeating a pair of players of an earlier game of the batch are
+* dropped. The storage of the tournament is grown once for the games left,
+* then they are added in order, each as chessAddGame would add it: the games
+* a player may play count the earlier games of the batch.
+* If growing the storage fails, no game is added and every game left gets
+* CHESS_OUT_OF_MEMORY.
+* @param chess - chess system that contains the tournament.
+* @param tournament_id - the tournament id. Must be positive, and unique.
+* @param records - the games to add.
+* @param n - the number of games to add.
+* @param per_record - where to write the result of every game, the value
+*   chessAddGame would have returned for it at its place in the batch.
+* @return
+* CHESS_NULL_ARGUMENT if chess is NULL, or records or per_record are NULL
+*   while n is positive. Nothing is written to per_record.
+* The result of the first game which was not added, if there is one.
+* CHESS_SUCCESS otherwise.
+*/
+ChessResult chessAddGames(ChessSystem chess, int tournament_id, const GameRecord *records, int n,
+                          ChessResult *per_record);
+
+#endif /* CHESS_BATCH_H_ */
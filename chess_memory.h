@@ -0,0 +1,40 @@
+#ifndef CHESS_MEMORY_H_
+#define CHESS_MEMORY_H_
+
+#include <stdio.h>
+#include <stddef.h>
+#include "chessSystem.h"
+
+/** Bytes of memory used by a tournament, as filled in by tournamentMemoryUsage */
+typedef struct ChessMemoryUsage_t
+{
+    size_t tournament;      /* The tournament structure */
+    size_t location;        /* The location string */
+    size_t games_map;       /* The indexes of the games */
+    size_t games;           /* The games table */
+    size_t players_map;     /* The players map, without the players */
+    size_t players;         /* The players */
+    int games_count;
+    int players_count;
+} ChessMemoryUsage;
+
+/**
+* chessMemoryReport: writes the bytes of memory used by the chess system to
+* a file, one line per tournament in ascending id order:
+*   tournament <id>: <total> bytes (structure <bytes>, location <bytes>,
+*   games map <bytes>, <count> games <bytes>, players map <bytes>,
+*   <count> players <bytes>)
+* followed by a line for the whole system, whose structure includes the index
+* from players to their tournaments and the totals of the players:
+*   system: <total> bytes (structure <bytes>, tournaments map <bytes>,
+*   <count> tournaments <bytes>)
+* @param chess - chess system to measure.
+* @param file - file to write to.
+* @return
+* CHESS_NULL_ARGUMENT if one of the arguments is NULL.
+* CHESS_SAVE_FAILURE if writing to the file failed.
+* CHESS_SUCCESS otherwise.
+*/
+ChessResult chessMemoryReport(ChessSystem chess, FILE *file);
+
+#endif /* CHESS_MEMORY_H_ */
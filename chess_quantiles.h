@@ -0,0 +1,27 @@
+#ifndef CHESS_QUANTILES_H_
+#define CHESS_QUANTILES_H_
+
+#include <stdio.h>
+#include "chessSystem.h"
+
+/**
+* chessSavePlayTimeQuantiles: writes the median, 90th and 99th percentile of
+* the play times of the games to a file, one line per tournament with games
+* in ascending id order:
+*   tournament <id>: <count> games, p50 <seconds>, p90 <seconds>, p99 <seconds>
+* followed by a line for the games of all the tournaments:
+*   system: <count> games, p50 <seconds>, p90 <seconds>, p99 <seconds>
+* The percentiles come from the quantile sketch of every tournament, and are
+* within about 1.6% of the exact play times. The percentiles of a system
+* without games are 0.
+* @param chess - chess system to report.
+* @param file - file to write to.
+* @return
+* CHESS_NULL_ARGUMENT if one of the arguments is NULL.
+* CHESS_OUT_OF_MEMORY if an allocation failed.
+* CHESS_SAVE_FAILURE if writing to the file failed.
+* CHESS_SUCCESS otherwise.
+*/
+ChessResult chessSavePlayTimeQuantiles(ChessSystem chess, FILE *file);
+
+#endif /* CHESS_QUANTILES_H_ */
@@ -0,0 +1,20 @@
+#ifndef CHESS_RANKING_H_
+#define CHESS_RANKING_H_
+
+#include "chessSystem.h"
+
+/**
+* chessSetRankingWorkers: sets the most threads chessSavePlayersLevels sorts
+* the players with. Each thread is given at least
+* RANKING_MIN_PLAYERS_PER_WORKER players (see ranking.h), so smaller exports
+* use fewer threads. The order of the export does not depend on the number
+* of threads. A new chess system sorts in the calling thread only.
+* @param chess - chess system to configure.
+* @param workers - the most threads to sort with, values below 1 mean 1.
+* @return
+* CHESS_NULL_ARGUMENT if chess is NULL.
+* CHESS_SUCCESS otherwise.
+*/
+ChessResult chessSetRankingWorkers(ChessSystem chess, int workers);
+
+#endif /* CHESS_RANKING_H_ */
@@ -0,0 +1,43 @@
+#ifndef CHESS_SNAPSHOT_H_
+#define CHESS_SNAPSHOT_H_
+
+#include "chessSystem.h"
+
+/**
+* Binary snapshots of a chess system.
+* A snapshot holds the tournaments in ascending id order, each with its games
+* table column by column and its players in ascending id order. The indexes,
+* standings, play time sketches and player totals are not saved; loading
+* rebuilds them in one pass over the games and players, so a loaded system
+* behaves exactly like the saved one.
+* A snapshot is only meant to be read on the kind of machine which wrote it,
+* and one written by another version of the format is rejected.
+*/
+
+/**
+* chessSaveSnapshot: writes a binary snapshot of a chess system to a file.
+* @param chess - chess system to save.
+* @param path - path of the file to write, replaced if it exists.
+* @return
+* CHESS_NULL_ARGUMENT if one of the arguments is NULL.
+* CHESS_SAVE_FAILURE if the file could not be written.
+* CHESS_SUCCESS otherwise.
+*/
+ChessResult chessSaveSnapshot(ChessSystem chess, const char *path);
+
+/**
+* chessLoadSnapshot: creates a chess system from a snapshot written by
+* chessSaveSnapshot. The file is mapped into memory and read in place.
+* @param path - path of the snapshot file.
+* @param result - where to write the status of the function:
+*   CHESS_NULL_ARGUMENT if one of the arguments is NULL.
+*   CHESS_OUT_OF_MEMORY if an allocation failed.
+*   CHESS_SAVE_FAILURE if the file could not be read, or is not a snapshot
+*     of this version, or is cut or corrupt.
+*   CHESS_SUCCESS otherwise.
+* @return
+* A new chess system if successful, NULL otherwise.
+*/
+ChessSystem chessLoadSnapshot(const char *path, ChessResult *result);
+
+#endif /* CHESS_SNAPSHOT_H_ */
@@ -9,113 +9,213 @@
 #define NULL_PLAYER -1
 #define REDUCE -1
 #define ADD 1
+#define GAME_TABLE_INITIAL_CAPACITY 16
+#define GAME_SNAPSHOT_CHUNK 1024
 
-static void setNewStatsForPlayerRemove(Game game, Player player, Winner this_player, Winner other_player);
+static void setNewStatsForPlayerRemove(GameTable games, int index, Player player,
+                                       Winner this_player, Winner other_player);
+static bool gameTableResize(GameTable games, int capacity);
+static bool gameSnapshotPlayersValid(const int *players, int size);
 
-struct Game_t
+struct game_table_t
 {
-    int first_player;
-    int second_player;
-    Winner winner;
-    int play_time;
+    int *first_players;
+    int *second_players;
+    Winner *winners;
+    int *play_times;
+    int size;
+    int capacity;
 };
 
-Game gameCreate(int first_player, int second_player, Winner winner, int play_time, ChessResult *result)
+GameTable gameTableCreate()
 {
-    if (first_player <= 0 || second_player <= 0 || first_player == second_player)
-    {
-        *result = CHESS_INVALID_ID;
-        return NULL;
-    }
-    if (play_time <= 0)
+    GameTable games = malloc(sizeof(*games));
+    if (games == NULL)
     {
-        *result = CHESS_INVALID_PLAY_TIME;
         return NULL;
     }
-    Game new_game = malloc(sizeof(*new_game));
-    if (new_game == NULL)
+    games->first_players = NULL;
+    games->second_players = NULL;
+    games->winners = NULL;
+    games->play_times = NULL;
+    games->size = 0;
+    games->capacity = 0;
+    if (!gameTableResize(games, GAME_TABLE_INITIAL_CAPACITY))
     {
-        *result = CHESS_OUT_OF_MEMORY;
+        gameTableDestroy(games);
         return NULL;
     }
-    new_game->first_player = first_player;
-    new_game->second_player = second_player;
-    new_game->winner = winner;
-    new_game->play_time = play_time;
-    *result = CHESS_SUCCESS;
-    return new_game;
+    return games;
 }
 
-void gameDestroy(Game game)
+void gameTableDestroy(GameTable games)
 {
-    free(game);
+    if (games == NULL)
+    {
+        return;
+    }
+    free(games->first_players);
+    free(games->second_players);
+    free(games->winners);
+    free(games->play_times);
+    free(games);
 }
 
-int gameGetWinner(Game game)
+/** Grows every column to a capacity, leaving the table unchanged on failure */
+bool gameTableResize(GameTable games, int capacity)
 {
-    return game->winner;
+    int *first_players = realloc(games->first_players, sizeof(*first_players) * capacity);
+    if (first_players == NULL)
+    {
+        return false;
+    }
+    games->first_players = first_players;
+    int *second_players = realloc(games->second_players, sizeof(*second_players) * capacity);
+    if (second_players == NULL)
+    {
+        return false;
+    }
+    games->second_players = second_players;
+    Winner *winners = realloc(games->winners, sizeof(*winners) * capacity);
+    if (winners == NULL)
+    {
+        return false;
+    }
+    games->winners = winners;
+    int *play_times = realloc(games->play_times, sizeof(*play_times) * capacity);
+    if (play_times == NULL)
+    {
+        return false;
+    }
+    games->play_times = play_times;
+    games->capacity = capacity;
+    return true;
 }
-int gameGetPlaytime(Game game)
+
+GameTable gameTableCopy(GameTable games)
 {
-    return game->play_time;
+    assert(games != NULL);
+    if (games == NULL)
+    {
+        return NULL;
+    }
+    GameTable games_copy = gameTableCreate();
+    if (games_copy == NULL)
+    {
+        return NULL;
+    }
+    if (!gameTableReserve(games_copy, games->size))
+    {
+        gameTableDestroy(games_copy);
+        return NULL;
+    }
+    for (int i = 0; i < games->size; i++)
+    {
+        games_copy->first_players[i] = games->first_players[i];
+        games_copy->second_players[i] = games->second_players[i];
+        games_copy->winners[i] = games->winners[i];
+        games_copy->play_times[i] = games->play_times[i];
+    }
+    games_copy->size = games->size;
+    return games_copy;
 }
-int gameGetFirstPlayer(Game game)
+
+int gameTableGetSize(GameTable games)
 {
-    return game->first_player;
+    return games == NULL ? -1 : games->size;
 }
-int gameGetSecondPlayer(Game game)
+
+bool gameTableReserve(GameTable games, int size)
 {
-    return game->second_player;
+    int capacity = games->capacity;
+    while (capacity < size)
+    {
+        capacity *= 2;
+    }
+    return capacity == games->capacity || gameTableResize(games, capacity);
 }
 
-Game gameCopy(Game game)
+ChessResult gameTableAdd(GameTable games, int first_player, int second_player, Winner winner,
+                         int play_time, int *game_id)
 {
-    assert(game != NULL);
-    if (game == NULL)
+    if (first_player <= 0 || second_player <= 0 || first_player == second_player)
     {
-        return NULL;
+        return CHESS_INVALID_ID;
     }
-    ChessResult result;
-    Game game_copy = gameCreate(game->first_player, game->second_player,
-                                game->winner, game->play_time, &result);
-    if (game_copy == NULL)
+    if (play_time <= 0)
     {
-        return NULL;
+        return CHESS_INVALID_PLAY_TIME;
     }
-    return game_copy;
+    if (!gameTableReserve(games, games->size + 1))
+    {
+        return CHESS_OUT_OF_MEMORY;
+    }
+    int index = games->size++;
+    games->first_players[index] = first_player;
+    games->second_players[index] = second_player;
+    games->winners[index] = winner;
+    games->play_times[index] = play_time;
+    *game_id = index + 1;
+    return CHESS_SUCCESS;
+}
+
+void gameTableRemoveLast(GameTable games)
+{
+    if (games != NULL && games->size > 0)
+    {
+        games->size--;
+    }
+}
+
+int gameGetWinner(GameTable games, int game_id)
+{
+    return games->winners[game_id - 1];
+}
+int gameGetPlaytime(GameTable games, int game_id)
+{
+    return games->play_times[game_id - 1];
+}
+int gameGetFirstPlayer(GameTable games, int game_id)
+{
+    return games->first_players[game_id - 1];
+}
+int gameGetSecondPlayer(GameTable games, int game_id)
+{
+    return games->second_players[game_id - 1];
 }
 
-void setNewStatsForPlayerRemove(Game game, Player player, Winner this_player, Winner other_player)
+void setNewStatsForPlayerRemove(GameTable games, int index, Player player,
+                                Winner this_player, Winner other_player)
 {
     if(playerGetGames(player)!=0)
         {
-            if(game->winner==DRAW)
+            if(games->winners[index]==DRAW)
             {
                 playerAddDraws(player,REDUCE);
-            }   
-            else if(game->winner==other_player)
+            }
+            else if(games->winners[index]==other_player)
             {
                 playerAddLoses(player,REDUCE);
             }
-            if(game->winner!=this_player)
+            if(games->winners[index]!=this_player)
             {
                 playerAddWins(player,ADD);
             }
         }
         if(other_player == FIRST_PLAYER)
         {
-            game->first_player = NULL_PLAYER;
+            games->first_players[index] = NULL_PLAYER;
         }
         else if(other_player == SECOND_PLAYER)
         {
-            game->second_player = NULL_PLAYER;
+            games->second_players[index] = NULL_PLAYER;
         }
-        game->winner = this_player;
+        games->winners[index] = this_player;
 }
 
-ChessResult gameRemovePlayer(Map players, Game game, int *game_id, int player_id)
+ChessResult gameRemovePlayer(PlayerMap players, GameTable games, int game_id, int player_id)
 {
-    if (!game)
+    if (!games)
     {
         return CHESS_NULL_ARGUMENT;
     }
@@ -123,24 +223,118 @@ ChessResult gameRemovePlayer(Map players, Game game, int *game_id, int player_id
     {
         return CHESS_INVALID_ID;
     }
-    if (player_id == game->first_player)
+    int index = game_id - 1;
+    if (player_id == games->first_players[index])
     {
-        Player player = mapGet(players,(MapKeyElement)(&(game->second_player)));
+        Player player = playerMapGet(players, games->second_players[index]);
         if(!player)
         {
             return CHESS_OUT_OF_MEMORY;
         }
-        setNewStatsForPlayerRemove(game,player,SECOND_PLAYER,FIRST_PLAYER);
-        
+        setNewStatsForPlayerRemove(games,index,player,SECOND_PLAYER,FIRST_PLAYER);
+
     }
-    else if (player_id == game->second_player)
+    else if (player_id == games->second_players[index])
     {
-        Player player = mapGet(players,(MapKeyElement)(&(game->first_player)));
+        Player player = playerMapGet(players, games->first_players[index]);
         if(!player)
         {
             return CHESS_OUT_OF_MEMORY;
         }
-        setNewStatsForPlayerRemove(game,player,FIRST_PLAYER,SECOND_PLAYER);
+        setNewStatsForPlayerRemove(games,index,player,FIRST_PLAYER,SECOND_PLAYER);
+    }
+    return CHESS_SUCCESS;
+}
+
+bool gameTableSaveSnapshot(GameTable games, FILE *file)
+{
+    if (!snapshotWriteInts(file, &games->size, 1) ||
+        !snapshotWriteInts(file, games->first_players, games->size) ||
+        !snapshotWriteInts(file, games->second_players, games->size) ||
+        !snapshotWriteInts(file, games->play_times, games->size))
+    {
+        return false;
+    }
+    int winners[GAME_SNAPSHOT_CHUNK];
+    for (int start = 0; start < games->size; start += GAME_SNAPSHOT_CHUNK)
+    {
+        int size = games->size - start < GAME_SNAPSHOT_CHUNK ? games->size - start : GAME_SNAPSHOT_CHUNK;
+        for (int i = 0; i < size; i++)
+        {
+            winners[i] = games->winners[start + i];
+        }
+        if (!snapshotWriteInts(file, winners, size))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Checks that every id of a player column is legal or NULL_PLAYER */
+bool gameSnapshotPlayersValid(const int *players, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        if (players[i] <= 0 && players[i] != NULL_PLAYER)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+ChessResult gameTableLoadSnapshot(GameTable games, SnapshotReader *reader)
+{
+    int size;
+    if (!snapshotReadInts(reader, &size, 1) || size < 0 ||
+        (size_t)size > (size_t)(reader->end - reader->position) / (sizeof(int) * 4))
+    {
+        return CHESS_SAVE_FAILURE;
+    }
+    if (!gameTableReserve(games, size))
+    {
+        return CHESS_OUT_OF_MEMORY;
+    }
+    if (!snapshotReadInts(reader, games->first_players, size) ||
+        !snapshotReadInts(reader, games->second_players, size) ||
+        !snapshotReadInts(reader, games->play_times, size) ||
+        !gameSnapshotPlayersValid(games->first_players, size) ||
+        !gameSnapshotPlayersValid(games->second_players, size))
+    {
+        return CHESS_SAVE_FAILURE;
+    }
+    int winners[GAME_SNAPSHOT_CHUNK];
+    for (int start = 0; start < size; start += GAME_SNAPSHOT_CHUNK)
+    {
+        int chunk = size - start < GAME_SNAPSHOT_CHUNK ? size - start : GAME_SNAPSHOT_CHUNK;
+        if (!snapshotReadInts(reader, winners, chunk))
+        {
+            return CHESS_SAVE_FAILURE;
+        }
+        for (int i = 0; i < chunk; i++)
+        {
+            int index = start + i;
+            if ((winners[i] != FIRST_PLAYER && winners[i] != SECOND_PLAYER && winners[i] != DRAW) ||
+                games->play_times[index] <= 0 ||
+                (games->first_players[index] == games->second_players[index] &&
+                 games->first_players[index] != NULL_PLAYER))
+            {
+                return CHESS_SAVE_FAILURE;
+            }
+            games->winners[index] = winners[i];
+        }
     }
+    games->size = size;
     return CHESS_SUCCESS;
 }
+
+size_t gameTableMemoryUsage(GameTable games)
+{
+    if (games == NULL)
+    {
+        return 0;
+    }
+    return sizeof(*games) + (sizeof(*games->first_players) + sizeof(*games->second_players) +
+                             sizeof(*games->winners) + sizeof(*games->play_times)) * games->capacity;
+}
@@ -2,90 +2,164 @@
 #define GAME_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "chessSystem.h"
+#include "player.h"
 
 /**
- * Game object for storing single game data.
- * 
+ * Game table object for storing the games of a tournament.
+ * The games are kept column by column: the first players, the second
+ * players, the winners and the play times each have their own array,
+ * indexed by the game id. Game ids are given in order, starting from 1.
+ *
  * Functions:
- * gameCreate: Allocates a new game.
- * gameDestroy: Frees game from memory.
- * gameGetWinner: returns game`s winner`s id.
+ * gameTableCreate: Allocates a new empty game table.
+ * gameTableDestroy: Frees game table from memory.
+ * gameTableCopy: returns game table copy.
+ * gameTableGetSize: returns the number of games in the table.
+ * gameTableReserve: makes room for games to be added.
+ * gameTableAdd: adds a game to the table.
+ * gameTableRemoveLast: removes the last game added.
+ * gameGetWinner: returns game`s winner.
  * gameGetPlaytime: returns game`s length in seconds.
  * gameGetFirstPlayer: returns game`s first player`s id.
  * gameGetSecondPlayer: returns game`s second player`s id.
- * gameCopy: returns game copy for map purposes.
  * gameRemovePlayer: remove player from game and updates stats.
  */
 
-typedef struct Game_t *Game;
+typedef struct game_table_t *GameTable;
 
 /**
- * gameCreate: Allocates a new game.
+ * gameTableCreate: Allocates a new empty game table.
+ * @return
+ * A new game table in case of success, NULL if allocation failed.
+ */
+GameTable gameTableCreate();
+
+/**
+ * gameTableDestroy: Frees game table from memory.
+ * @param games - game table to free.
+ */
+void gameTableDestroy(GameTable games);
+
+/**
+ * gameTableCopy: returns a copy of the game table.
+ * @param games - The game table we wish to copy.
+ * @return - a copy of the game table, NULL if failed.
+ */
+GameTable gameTableCopy(GameTable games);
+
+/**
+ * gameTableGetSize: returns the number of games in the table.
+ * @param games - The game table.
+ * @return - -1 if games is NULL, the number of games otherwise.
+ */
+int gameTableGetSize(GameTable games);
+
+/**
+ * gameTableReserve: makes room for a number of games, so that adding them
+ * does not grow the columns.
+ * @param games - The game table.
+ * @param size - the number of games to make room for.
+ * @return - false if the allocation failed, true otherwise.
+ */
+bool gameTableReserve(GameTable games, int size);
+
+/**
+ * gameTableAdd: Adds a new game to the table.
+ * @param games - the game table.
  * @param first_player - player 1 id.
  * @param second_player - player 2 id.
  * @param winner - enum for the winner of the game (FIRST/SECOND/DRAW)
  * @param play_time - play time_played in seconds (bigger than zero)
- * @param result - enum for the function result
+ * @param game_id - where to write the id of the new game.
+ * @return
  * CHESS_INVALID_ID if the id is not legal - less or equal to 0.
  * CHESS_INVALID_PLAY_TIME play time is not legal - less than 0.
  * CHESS_OUT_OF_MEMORY - allocatione error occured.
  * CHESS_SUCCESS - everything is ok.
- * @return
- * A new game in case of success, NULL if error occured.
  */
-Game gameCreate(int first_player, int second_player, Winner winner, int play_time, ChessResult *result);
+ChessResult gameTableAdd(GameTable games, int first_player, int second_player, Winner winner,
+                         int play_time, int *game_id);
 
 /**
- * gameDestroy: Frees game from memory.
- * @param game - game to free.
+ * gameTableRemoveLast: removes the game added last to the table.
+ * @param games - the game table.
  */
-void gameDestroy(Game game);
+void gameTableRemoveLast(GameTable games);
 
 /**
- * gameGetWinner: returns game`s winner`s id.
- * @param game - The game we wish to get the winner from.
- * @return - Winning player`s id.
+ * gameGetWinner: returns game`s winner.
+ * @param games - the game table.
+ * @param game_id - The game we wish to get the winner from.
+ * @return - the winner of the game.
  */
-int gameGetWinner(Game game);
+int gameGetWinner(GameTable games, int game_id);
 
 /**
  * gameGetPlaytime: returns game`s length in seconds.
- * @param game - The game we wish to get the length of.
+ * @param games - the game table.
+ * @param game_id - The game we wish to get the length of.
  * @return - Game`s length in seconds.
  */
-int gameGetPlaytime(Game game);
+int gameGetPlaytime(GameTable games, int game_id);
 
 /**
  * gameGetFirstPlayer: returns game`s first player`s id.
- * @param game - The game we wish to get the first player`s id from.
+ * @param games - the game table.
+ * @param game_id - The game we wish to get the first player`s id from.
  * @return - first player`s id.
  */
-int gameGetFirstPlayer(Game game);
+int gameGetFirstPlayer(GameTable games, int game_id);
 
 /**
  * gameGetSecondPlayer: returns game`s second player`s id.
- * @param game - The game we wish to get the second player`s id from.
+ * @param games - the game table.
+ * @param game_id - The game we wish to get the second player`s id from.
  * @return - second player`s id.
  */
-int gameGetSecondPlayer(Game game);
-
-/**
- * gameCopy: returns a copy of the game`s data.
- * @param game - The game we wish to copy.
- * @return - a copy of the game, NULL if failed.
- */
-Game gameCopy(Game game);
+int gameGetSecondPlayer(GameTable games, int game_id);
 
 /**
 * gameRemovePlayer: remove player from the game and updates stats for the second player.
-* @param game - The game we remove the player from.
+* @param players - the players of the tournament of the game.
+* @param games - the game table.
+* @param game_id - The game we remove the player from.
 * @param player_id - The id of the player we wish to remove.
 * @return
 * CHESS_NULL_ARGUMENT - one of the arguments is NULL.
 * CHESS_INVALID_ID - The id is illegal.
 * CHESS_SUCCESS - if function succeed.
 */
-ChessResult gameRemovePlayer(Map players, Game game, int* game_id, int player_id);
+ChessResult gameRemovePlayer(PlayerMap players, GameTable games, int game_id, int player_id);
+
+/**
+* gameTableSaveSnapshot: writes the games of a table to a snapshot file.
+* @param games - the game table.
+* @param file - the snapshot file.
+* @return
+* false if the write failed, true otherwise.
+*/
+bool gameTableSaveSnapshot(GameTable games, FILE *file);
+
+/**
+* gameTableLoadSnapshot: fills an empty game table from a snapshot, as
+* written by gameTableSaveSnapshot, copying every column in one piece.
+* @param games - the empty game table to fill.
+* @param reader - the snapshot to read from.
+* @return
+* CHESS_OUT_OF_MEMORY if an allocation failed.
+* CHESS_SAVE_FAILURE if the snapshot is cut or corrupt.
+* CHESS_SUCCESS otherwise.
+*/
+ChessResult gameTableLoadSnapshot(GameTable games, SnapshotReader *reader);
+
+/**
+* gameTableMemoryUsage: returns the bytes of memory used by a game table.
+* @param games - game table to measure.
+* @return
+* 0 if games is NULL, the size of the table and its columns otherwise.
+*/
+size_t gameTableMemoryUsage(GameTable games);
 
-#endif
\ No newline at end of file
+#endif
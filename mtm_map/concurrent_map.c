@@ -0,0 +1,305 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "concurrent_map.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+#define NULL_MAP_SIZE -1
+#define HASH_MULTIPLIER 2654435769u
+
+#ifdef MAP_STATISTICS
+#define SHARD_READ_LOCK(shard) pthread_rwlock_wrlock(&(shard)->lock)
+#else
+#define SHARD_READ_LOCK(shard) pthread_rwlock_rdlock(&(shard)->lock)
+#endif
+#define SHARD_WRITE_LOCK(shard) pthread_rwlock_wrlock(&(shard)->lock)
+#define SHARD_UNLOCK(shard) pthread_rwlock_unlock(&(shard)->lock)
+
+typedef struct Shard_t
+{
+    pthread_rwlock_t lock;
+    Map map;
+} *Shard;
+
+struct ConcurrentMap_t
+{
+    struct Shard_t *shards;
+    int shard_count;
+    hashMapKeyElements hashKey;
+    copyMapDataElements copyData;
+};
+
+static ConcurrentMap concurrentMapAllocate(copyMapDataElements copyDataElement,
+                                           hashMapKeyElements hashKeyElement, int shards);
+static void concurrentMapFree(ConcurrentMap map, int initialized);
+static Shard concurrentMapShard(ConcurrentMap map, MapKeyElement key);
+static unsigned int hashIntKey(MapKeyElement key);
+static int compareIntKeys(MapKeyElement key_1, MapKeyElement key_2);
+
+/** Allocates a map with shards rounded up to a power of two, without their maps */
+static ConcurrentMap concurrentMapAllocate(copyMapDataElements copyDataElement,
+                                           hashMapKeyElements hashKeyElement, int shards)
+{
+    if (shards <= 0)
+    {
+        return NULL;
+    }
+    ConcurrentMap map = malloc(sizeof(*map));
+    if (map == NULL)
+    {
+        return NULL;
+    }
+    map->shard_count = 1;
+    while (map->shard_count < shards && map->shard_count < CONCURRENT_MAP_MAX_SHARDS)
+    {
+        map->shard_count *= 2;
+    }
+    map->shards = malloc(sizeof(*map->shards) * map->shard_count);
+    if (map->shards == NULL)
+    {
+        free(map);
+        return NULL;
+    }
+    map->hashKey = hashKeyElement;
+    map->copyData = copyDataElement;
+    return map;
+}
+
+/** Frees a map whose first initialized shards have a lock and a map */
+static void concurrentMapFree(ConcurrentMap map, int initialized)
+{
+    for (int i = 0; i < initialized; i++)
+    {
+        mapDestroy(map->shards[i].map);
+        pthread_rwlock_destroy(&map->shards[i].lock);
+    }
+    free(map->shards);
+    free(map);
+}
+
+/** Returns the shard of key. The hash is mixed so weak hashes still spread */
+static Shard concurrentMapShard(ConcurrentMap map, MapKeyElement key)
+{
+    unsigned int hash = map->hashKey(key) * HASH_MULTIPLIER;
+    return map->shards + ((hash >> 16) & (unsigned int)(map->shard_count - 1));
+}
+
+static unsigned int hashIntKey(MapKeyElement key)
+{
+    return (unsigned int)*(int *)key;
+}
+
+static int compareIntKeys(MapKeyElement key_1, MapKeyElement key_2)
+{
+    int first = *(int *)key_1;
+    int second = *(int *)key_2;
+    return (first > second) - (first < second);
+}
+
+ConcurrentMap concurrentMapCreate(copyMapDataElements copyDataElement,
+                                  copyMapKeyElements copyKeyElement,
+                                  freeMapDataElements freeDataElement,
+                                  freeMapKeyElements freeKeyElement,
+                                  compareMapKeyElements compareKeyElements,
+                                  hashMapKeyElements hashKeyElement,
+                                  int shards)
+{
+    if (copyDataElement == NULL || copyKeyElement == NULL || freeDataElement == NULL ||
+        freeKeyElement == NULL || compareKeyElements == NULL || hashKeyElement == NULL)
+    {
+        return NULL;
+    }
+    ConcurrentMap map = concurrentMapAllocate(copyDataElement, hashKeyElement, shards);
+    if (map == NULL)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < map->shard_count; i++)
+    {
+        Shard shard = map->shards + i;
+        shard->map = mapCreate(copyDataElement, copyKeyElement, freeDataElement,
+                               freeKeyElement, compareKeyElements);
+        if (shard->map == NULL)
+        {
+            concurrentMapFree(map, i);
+            return NULL;
+        }
+        if (pthread_rwlock_init(&shard->lock, NULL) != 0)
+        {
+            mapDestroy(shard->map);
+            concurrentMapFree(map, i);
+            return NULL;
+        }
+    }
+    return map;
+}
+
+ConcurrentMap concurrentMapCreateInt(copyMapDataElements copyDataElement,
+                                     freeMapDataElements freeDataElement,
+                                     int shards)
+{
+    if (copyDataElement == NULL || freeDataElement == NULL)
+    {
+        return NULL;
+    }
+    ConcurrentMap map = concurrentMapAllocate(copyDataElement, hashIntKey, shards);
+    if (map == NULL)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < map->shard_count; i++)
+    {
+        Shard shard = map->shards + i;
+        shard->map = mapCreateInline(copyDataElement, freeDataElement, compareIntKeys, sizeof(int));
+        if (shard->map == NULL)
+        {
+            concurrentMapFree(map, i);
+            return NULL;
+        }
+        if (pthread_rwlock_init(&shard->lock, NULL) != 0)
+        {
+            mapDestroy(shard->map);
+            concurrentMapFree(map, i);
+            return NULL;
+        }
+    }
+    return map;
+}
+
+void concurrentMapDestroy(ConcurrentMap map)
+{
+    if (map == NULL)
+    {
+        return;
+    }
+    concurrentMapFree(map, map->shard_count);
+}
+
+int concurrentMapGetSize(ConcurrentMap map)
+{
+    if (map == NULL)
+    {
+        return NULL_MAP_SIZE;
+    }
+    int size = 0;
+    for (int i = 0; i < map->shard_count; i++)
+    {
+        Shard shard = map->shards + i;
+        SHARD_READ_LOCK(shard);
+        size += mapGetSize(shard->map);
+        SHARD_UNLOCK(shard);
+    }
+    return size;
+}
+
+bool concurrentMapContains(ConcurrentMap map, MapKeyElement element)
+{
+    if (map == NULL || element == NULL)
+    {
+        return false;
+    }
+    Shard shard = concurrentMapShard(map, element);
+    SHARD_READ_LOCK(shard);
+    bool found = mapGet(shard->map, element) != NULL;
+    SHARD_UNLOCK(shard);
+    return found;
+}
+
+MapResult concurrentMapPut(ConcurrentMap map, MapKeyElement keyElement, MapDataElement dataElement)
+{
+    if (map == NULL || keyElement == NULL || dataElement == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    Shard shard = concurrentMapShard(map, keyElement);
+    SHARD_WRITE_LOCK(shard);
+    MapResult result = mapPut(shard->map, keyElement, dataElement);
+    SHARD_UNLOCK(shard);
+    return result;
+}
+
+MapDataElement concurrentMapGet(ConcurrentMap map, MapKeyElement keyElement)
+{
+    if (map == NULL || keyElement == NULL)
+    {
+        return NULL;
+    }
+    Shard shard = concurrentMapShard(map, keyElement);
+    SHARD_READ_LOCK(shard);
+    MapDataElement data = mapGet(shard->map, keyElement);
+    MapDataElement copy = data == NULL ? NULL : map->copyData(data);
+    SHARD_UNLOCK(shard);
+    return copy;
+}
+
+MapResult concurrentMapUpdate(ConcurrentMap map, MapKeyElement keyElement,
+                              updateMapDataElements update, void *context)
+{
+    if (map == NULL || keyElement == NULL || update == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    Shard shard = concurrentMapShard(map, keyElement);
+    SHARD_WRITE_LOCK(shard);
+    MapDataElement data = mapGet(shard->map, keyElement);
+    if (data != NULL)
+    {
+        update(data, context);
+    }
+    SHARD_UNLOCK(shard);
+    return data == NULL ? MAP_ITEM_DOES_NOT_EXIST : MAP_SUCCESS;
+}
+
+MapResult concurrentMapRemove(ConcurrentMap map, MapKeyElement keyElement)
+{
+    if (map == NULL || keyElement == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    Shard shard = concurrentMapShard(map, keyElement);
+    SHARD_WRITE_LOCK(shard);
+    MapResult result = mapRemove(shard->map, keyElement);
+    SHARD_UNLOCK(shard);
+    return result;
+}
+
+MapResult concurrentMapClear(ConcurrentMap map)
+{
+    if (map == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    MapResult result = MAP_SUCCESS;
+    for (int i = 0; i < map->shard_count; i++)
+    {
+        Shard shard = map->shards + i;
+        SHARD_WRITE_LOCK(shard);
+        if (mapClear(shard->map) != MAP_SUCCESS)
+        {
+            result = MAP_OUT_OF_MEMORY;
+        }
+        SHARD_UNLOCK(shard);
+    }
+    return result;
+}
+
+MapResult concurrentMapForEach(ConcurrentMap map, visitMapElements visit, void *context)
+{
+    if (map == NULL || visit == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    bool go_on = true;
+    for (int i = 0; i < map->shard_count && go_on; i++)
+    {
+        Shard shard = map->shards + i;
+        SHARD_READ_LOCK(shard);
+        for (MapCursor cursor = mapCursorFirst(shard->map); go_on && mapCursorIsValid(&cursor);
+             mapCursorNext(&cursor))
+        {
+            go_on = visit(mapCursorGetKey(&cursor), mapCursorGetData(&cursor), context);
+        }
+        SHARD_UNLOCK(shard);
+    }
+    return MAP_SUCCESS;
+}
@@ -0,0 +1,229 @@
+#ifndef CONCURRENT_MAP_H_
+#define CONCURRENT_MAP_H_
+
+#include <stdbool.h>
+#include "map.h"
+
+/**
+* Concurrent Map Container
+*
+* A map which several threads may read and change at the same time.
+* Keys are spread by their hash over a fixed number of shards, each of them
+* a Map guarded by its own reader/writer lock. Lookups take only the read
+* lock of one shard, so they run in parallel with each other and with
+* changes to other shards; a change locks its shard alone.
+* Shards are ordered maps (mapCreateInline for int keys), whose lookups and
+* cursors do not change the map, so concurrent readers never write to
+* shared memory.
+* Pointers into the map are never handed out: lookups return copies of the
+* data, changes in place go through concurrentMapUpdate, and iteration calls
+* a visitor while the shard is locked.
+* When map.c is built with MAP_STATISTICS defined, concurrent_map.c must be
+* built with it too, and every operation then locks its shard for writing,
+* since the work counters are written by lookups.
+*
+* The following functions are available:
+*   concurrentMapCreate	- Creates a new empty map
+*   concurrentMapCreateInt - Creates a new empty map keyed by int
+*   concurrentMapDestroy	- Deletes an existing map and frees all resources
+*   concurrentMapGetSize	- Returns the number of pairs in the map
+*   concurrentMapContains	- Returns weather or not a key exists inside the map
+*   concurrentMapPut		- Gives a specific key a copy of a given value
+*   concurrentMapGet		- Returns a copy of the data paired to a key
+*   concurrentMapUpdate	- Changes the data paired to a key in place
+*   concurrentMapRemove	- Removes the pair of a given key
+*   concurrentMapClear	- Removes all the pairs of the map
+*   concurrentMapForEach	- Calls a function on every pair of the map
+*/
+
+/** Largest number of shards a concurrent map is split into */
+#define CONCURRENT_MAP_MAX_SHARDS 1024
+
+/** Type for defining the concurrent map */
+typedef struct ConcurrentMap_t *ConcurrentMap;
+
+/** Type of function for hashing a key element of the map */
+typedef unsigned int(*hashMapKeyElements)(MapKeyElement);
+
+/** Type of function for changing a data element in place */
+typedef void(*updateMapDataElements)(MapDataElement data, void *context);
+
+/**
+* Type of function called by concurrentMapForEach on every pair.
+* Returns false to stop the iteration.
+*/
+typedef bool(*visitMapElements)(MapKeyElement key, MapDataElement data, void *context);
+
+/**
+* concurrentMapCreate: Allocates a new empty concurrent map.
+*
+* @param copyDataElement - Function pointer to be used for copying data elements into
+*  	the map and out of it.
+* @param copyKeyElement - Function pointer to be used for copying key elements into
+*  	the map.
+* @param freeDataElement - Function pointer to be used for removing data elements from
+* 		the map
+* @param freeKeyElement - Function pointer to be used for removing key elements from
+* 		the map
+* @param compareKeyElements - Function pointer to be used for comparing key elements
+* 		inside the map.
+* @param hashKeyElement - Function pointer to be used for choosing the shard of a
+* 		key. Keys which compare equal must have equal hashes.
+* @param shards - The number of shards, rounded up to a power of two and at
+* 		most CONCURRENT_MAP_MAX_SHARDS. A few times the number of threads
+* 		using the map keeps them from waiting on each other.
+* @return
+* 	NULL - if one of the parameters is NULL, shards is not positive or
+* 		allocations failed.
+* 	A new ConcurrentMap in case of success.
+*/
+ConcurrentMap concurrentMapCreate(copyMapDataElements copyDataElement,
+                                  copyMapKeyElements copyKeyElement,
+                                  freeMapDataElements freeDataElement,
+                                  freeMapKeyElements freeKeyElement,
+                                  compareMapKeyElements compareKeyElements,
+                                  hashMapKeyElements hashKeyElement,
+                                  int shards);
+
+/**
+* concurrentMapCreateInt: Allocates a new empty concurrent map whose keys are
+* ints, passed as pointers to int. The keys are stored inline in the shards.
+*
+* @param copyDataElement - Function pointer to be used for copying data elements into
+*  	the map and out of it.
+* @param freeDataElement - Function pointer to be used for removing data elements from
+* 		the map
+* @param shards - The number of shards, as in concurrentMapCreate.
+* @return
+* 	NULL - if one of the parameters is NULL, shards is not positive or
+* 		allocations failed.
+* 	A new ConcurrentMap in case of success.
+*/
+ConcurrentMap concurrentMapCreateInt(copyMapDataElements copyDataElement,
+                                     freeMapDataElements freeDataElement,
+                                     int shards);
+
+/**
+* concurrentMapDestroy: Deallocates an existing map and all of its elements.
+* No other thread may use the map during or after this call.
+*
+* @param map - Target map to be deallocated. If map is NULL nothing will be
+* 		done
+*/
+void concurrentMapDestroy(ConcurrentMap map);
+
+/**
+* concurrentMapGetSize: Returns the number of pairs in the map.
+* The shards are counted one after the other, so while other threads change
+* the map the result may match no single moment of it.
+*
+* @param map - The map which size is requested
+* @return
+* 	-1 if a NULL pointer was sent.
+* 	Otherwise the number of elements in the map.
+*/
+int concurrentMapGetSize(ConcurrentMap map);
+
+/**
+* concurrentMapContains: Checks if a key element exists in the map.
+*
+* @param map - The map to search in
+* @param element - The element to look for.
+* @return
+* 	false - if one or more of the inputs is null, or if the key element was not found.
+* 	true - if the key element was found in the map.
+*/
+bool concurrentMapContains(ConcurrentMap map, MapKeyElement element);
+
+/**
+* concurrentMapPut: Gives a specified key a specified value, as mapPut does.
+* Copies of the key and the data are stored.
+*
+* @param map - The map for which to reassign the data element
+* @param keyElement - The key element which need to be reassigned
+* @param dataElement - The new data element to associate with the given key.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent as map or key or data.
+* 	MAP_OUT_OF_MEMORY if an allocation failed.
+* 	MAP_SUCCESS the paired elements had been inserted successfully
+*/
+MapResult concurrentMapPut(ConcurrentMap map, MapKeyElement keyElement, MapDataElement dataElement);
+
+/**
+* concurrentMapGet: Returns a copy of the data associated with a specific key.
+* The copy is made while the key's shard is locked, so it stays valid
+* whatever other threads do to the map, and it is owned by the caller, who
+* must release it with the data free function of the map.
+*
+* @param map - The map for which to get the data element from.
+* @param keyElement - The key element which need to be found and whose data
+*		we want to get.
+* @return
+*  NULL if a NULL pointer was sent, the key was not found or copying the
+*  	data failed.
+*  A copy of the data element associated with the key otherwise.
+*/
+MapDataElement concurrentMapGet(ConcurrentMap map, MapKeyElement keyElement);
+
+/**
+* concurrentMapUpdate: Calls a function on the data associated with a
+* specific key, while the key's shard is locked for writing.
+* The function must not use the map itself.
+*
+* @param map - The map holding the data element.
+* @param keyElement - The key element whose data is changed.
+* @param update - The function to call on the data element.
+* @param context - Passed to update as is.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent as map, key or function.
+* 	MAP_ITEM_DOES_NOT_EXIST if the key was not found.
+* 	MAP_SUCCESS if the function was called.
+*/
+MapResult concurrentMapUpdate(ConcurrentMap map, MapKeyElement keyElement,
+                              updateMapDataElements update, void *context);
+
+/**
+* concurrentMapRemove: Removes a pair of key and data elements from the map,
+* as mapRemove does.
+*
+* @param map - The map to remove the elements from.
+* @param keyElement - The key element to find and remove from the map.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent to the function.
+* 	MAP_ITEM_DOES_NOT_EXIST if an equal key item does not already exists in the map
+* 	MAP_SUCCESS the paired elements had been removed successfully
+*/
+MapResult concurrentMapRemove(ConcurrentMap map, MapKeyElement keyElement);
+
+/**
+* concurrentMapClear: Removes all key and data pairs from the map. The
+* shards are cleared one after the other.
+*
+* @param map - Target map to remove all element from.
+* @return
+* 	MAP_NULL_ARGUMENT - if a NULL pointer was sent.
+* 	MAP_OUT_OF_MEMORY if clearing a shard failed. The other shards are
+* 		still cleared.
+* 	MAP_SUCCESS - Otherwise.
+*/
+MapResult concurrentMapClear(ConcurrentMap map);
+
+/**
+* concurrentMapForEach: Calls a function on every pair of the map.
+* The shards are visited one after the other, each while it is locked for
+* reading, so other threads may look up keys of any shard and change the
+* shards not being visited. The pairs of a shard are visited in ascending
+* key order, but the map as a whole is not ordered.
+* The function must not change the map or keep the pointers it is given.
+*
+* @param map - The map to iterate over.
+* @param visit - The function to call on every pair. Returning false from it
+* 		stops the iteration.
+* @param context - Passed to visit as is.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent as map or function.
+* 	MAP_SUCCESS otherwise, whether or not visit stopped the iteration.
+*/
+MapResult concurrentMapForEach(ConcurrentMap map, visitMapElements visit, void *context);
+
+#endif /* CONCURRENT_MAP_H_ */
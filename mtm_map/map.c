@@ -1,17 +1,142 @@
 #include "map.h"
+#include "map_template.h"
+#include "node_pool.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
 #include <assert.h>
 
 #define NULL_MAP_SIZE -1
 
+/*
+ * With MAP_STATISTICS defined every map counts its work, see
+ * mapGetStatistics. Otherwise the counting compiles to nothing.
+ */
+#ifdef MAP_STATISTICS
+#define MAP_COUNT(map, counter) ((map)->statistics.counter++)
+#else
+#define MAP_COUNT(map, counter) ((void)0)
+#endif
+
+#define MAP_COMPARE_KEYS(map, key_1, key_2) (MAP_COUNT(map, key_comparisons), (map)->compareKey(key_1, key_2))
+#define MAP_COPY_KEY(map, key) (MAP_COUNT(map, key_copies), (map)->copyKey(key))
+#define MAP_FREE_KEY(map, key) \
+    (elementRelease(map, key) ? (MAP_COUNT(map, key_frees), (map)->freeKey(key)) : (void)0)
+#define MAP_COPY_DATA(map, data) (MAP_COUNT(map, data_copies), (map)->copyData(data))
+#define MAP_FREE_DATA(map, data) \
+    (elementRelease(map, data) ? (MAP_COUNT(map, data_frees), (map)->freeData(data)) : (void)0)
+
+/*
+ * The map is stored as a B+ tree. Every node holds up to NODE_CAPACITY keys
+ * in one contiguous array so a lookup touches a handful of cache lines per
+ * level. The pairs live in the leaves only. Iteration keeps the path from the
+ * root to the current leaf, so moving on to the next leaf is amortized O(1).
+ * Internal nodes hold their own copies of the separator keys: all the keys
+ * in children[i + 1] are greater or equal to keys[i].
+ * Insertion splits full nodes and removal refills thin nodes on the way
+ * down, so a single descent is enough and a failed allocation never leaves
+ * the tree unbalanced.
+ * Nodes are reference counted so that snapshots can share them. A node
+ * referenced more than once is never changed: the descent copies it first,
+ * so a change copies only the path to the changed key. The copy shares the
+ * key and data elements of the node instead of copying them: the pools the
+ * nodes come from, shared by the map and its snapshots, count for every such
+ * element how many more nodes hold it, and the element is freed only by the
+ * last of them. mapClear releases the pools slab by slab once nothing else
+ * uses them.
+ */
+#define NODE_CAPACITY 32
+#define NODE_MIN_KEYS (NODE_CAPACITY / 2 - 1)
+#define NODE_MIDDLE (NODE_CAPACITY / 2)
+
+/*
+ * Maps created by mapCreateInt keep their int keys inline in the open
+ * addressing table of map_template.h, the one MAP_DEFINE maps use. The map
+ * only adds the copying and freeing of data elements and the statistics.
+ * Such maps have no snapshots, a change to the table cannot copy a path.
+ */
+
+/*
+ * mapPutBatch merges a batch into a tree by rebuilding it in one pass, which
+ * costs O(n) however small the batch is. A batch smaller than 1 / ratio of
+ * the map is put pair by pair in key order instead.
+ */
+#define BATCH_REBUILD_RATIO 16
+
 typedef struct node_t
 {
+    bool is_leaf;
+    int size;
+    int references;
+} *Node;
+
+/*
+ * Both node kinds end with room for NODE_CAPACITY keys. A key is stored as
+ * the pointer returned by copyKey, or for maps created by mapCreateInline as
+ * the key bytes themselves, so the nodes are allocated from per-map pools
+ * sized for the map's key stride.
+ */
+typedef struct leaf_t
+{
+    struct node_t node;
+    MapDataElement data[NODE_CAPACITY];
+    MapKeyElement keys[];
+} *Leaf;
+
+typedef struct internal_t
+{
+    struct node_t node;
+    Node children[NODE_CAPACITY + 1];
+    MapKeyElement keys[];
+} *Internal;
+
+/** A key in the form it is stored in a node, kept aside while nodes change */
+typedef union stored_key_t
+{
+    MapKeyElement pointer;
+    unsigned char bytes[MAP_MAX_INLINE_KEY_SIZE];
+} StoredKey;
+
+/** A pair in the form it is stored in a leaf, kept aside while a tree is built */
+typedef struct tree_entry_t
+{
+    StoredKey key;
     MapDataElement data;
+} *TreeEntry;
+
+/** Where the elements of a merged entry come from, to undo a failed merge */
+typedef enum
+{
+    ENTRY_MOVED,
+    ENTRY_NEW_DATA,
+    ENTRY_NEW
+} EntryOrigin;
+
+typedef struct batch_pair_t
+{
     MapKeyElement key;
-    struct node_t *previous;
-    struct node_t *next;
-} * Node;
+    MapDataElement data;
+} *BatchPair;
+
+MAP_TABLE_DEFINE(IntTable, intTable, int, MapDataElement)
+
+/** For a key or data element held by more than one node, the number of extra holders */
+MAP_TABLE_DEFINE(ElementHolders, elementHolders, uintptr_t, int)
+
+/**
+ * The pools the nodes of a map come from, shared with its snapshots, and the
+ * holders of the elements those nodes share. holders is created by the
+ * first snapshot which copies a node.
+ */
+typedef struct node_store_t
+{
+    NodePool leaf_pool;
+    NodePool internal_pool;
+    ElementHolders holders;
+    int references;
+} *NodeStore;
 
 struct Map_t
 {
@@ -20,133 +145,1387 @@ struct Map_t
     freeMapDataElements freeData;
     freeMapKeyElements freeKey;
     compareMapKeyElements compareKey;
-    Node first;
-    Node current;
+    int inline_key_size;
+    size_t key_stride;
+    NodeStore store;
+    Node root;
+    MapCursor iterator;
     int counter;
+    bool int_keys;
+    IntTable table;
+#ifdef MAP_STATISTICS
+    MapStatistics statistics;
+#endif
 };
 
-Node createNode(Map map, MapDataElement data, MapKeyElement key,
-                Node previous, Node next);
-Node findKey(Map map, MapKeyElement keyElement);
+static Map mapAllocate(copyMapDataElements copyDataElement,
+                       copyMapKeyElements copyKeyElement,
+                       freeMapDataElements freeDataElement,
+                       freeMapKeyElements freeKeyElement,
+                       compareMapKeyElements compareKeyElements,
+                       int inline_key_size);
+static Map mapCreateLike(Map map);
+static Leaf leafCreate(Map map);
+static Internal internalCreate(Map map);
+static void nodeFree(Map map, Node node);
+static void nodeFreeEntries(Map map, Node node);
+static void nodeReleaseElements(Map map, Node node);
+static void nodeRelease(Map map, Node node);
+static void treeRelease(Map map);
+static bool elementRetain(Map map, void *element);
+static bool elementRelease(Map map, void *element);
+static Node nodeClone(Map map, Node node);
+static bool nodeUnshare(Map map, Node *reference);
+static unsigned char *nodeKeySlot(Map map, Node node, int index);
+static MapKeyElement nodeKey(Map map, Node node, int index);
+static void nodeMoveKeys(Map map, Node destination, int destination_index,
+                         Node source, int source_index, int count);
+static void nodeSetKey(Map map, Node node, int index, StoredKey *stored);
+static void nodeFreeKey(Map map, Node node, int index);
+static bool storedKeyCreate(Map map, MapKeyElement key, StoredKey *stored);
+static void storedKeyDestroy(Map map, StoredKey *stored);
+static MapKeyElement keyElementCopy(Map map, MapKeyElement key);
+static int nodeLowerBound(Map map, Node node, MapKeyElement key);
+static int internalChildIndex(Map map, Internal internal, MapKeyElement key);
+static bool findKey(Map map, MapKeyElement keyElement, Leaf *leaf, int *index);
+static MapResult splitChild(Map map, Internal parent, int index);
+static MapResult borrowFromLeft(Map map, Internal parent, int index);
+static MapResult borrowFromRight(Map map, Internal parent, int index);
+static void mergeChildren(Map map, Internal parent, int index);
+static MapResult fixChild(Map map, Internal parent, int *index);
+static MapKeyElement subtreeFirstKey(Map map, Node node);
+static void nodeFreeStructure(Map map, Node node);
+static void treeBuildAbort(Map map, Node *forest, int size);
+static MapResult treeBuildEntries(Map map, TreeEntry entries, int size, Node *root);
+static bool treeEntryCreate(Map map, MapKeyElement key, MapDataElement data, TreeEntry entry);
+static void treeEntriesDestroy(Map map, TreeEntry entries, int size);
+static MapResult treeBuildSorted(Map map, MapKeyElement *keys, MapDataElement *data, int size);
+static MapResult intMapBuildSorted(Map map, MapKeyElement *keys, MapDataElement *data, int size);
+static int batchSortUnique(Map map, BatchPair pairs, BatchPair buffer, int size);
+static MapResult treePutBatch(Map map, BatchPair pairs, int size);
+static MapResult intMapPutBatch(Map map, BatchPair pairs, int size);
+static void cursorDescend(MapCursor *cursor, Node node);
+static void cursorSettle(MapCursor *cursor);
+static MapKeyElement copyIntKey(MapKeyElement key);
+static void freeIntKey(MapKeyElement key);
+static int compareIntKeys(MapKeyElement key_1, MapKeyElement key_2);
+static void intMapRelease(Map map, IntTable table);
+static int intMapFind(Map map, int key);
+static MapDataElement newDataElement(Map map, MapDataElement dataElement, bool take_data);
+static void replaceDataElement(Map map, MapDataElement *stored, MapDataElement new_data);
+static MapResult intMapPut(Map map, int key, MapDataElement dataElement, bool take_data);
+static MapResult treePut(Map map, MapKeyElement keyElement, MapDataElement dataElement, bool take_data);
+static MapResult intMapRemove(Map map, int key);
+static void intMapClear(Map map);
+static IntTable intMapCopyTable(Map map);
+static void nodeMemoryUsage(Map map, Node node, sizeMapKeyElements keySize,
+                            sizeMapDataElements dataSize, MapMemoryUsage *usage);
+
+static Map mapAllocate(copyMapDataElements copyDataElement,
+                       copyMapKeyElements copyKeyElement,
+                       freeMapDataElements freeDataElement,
+                       freeMapKeyElements freeKeyElement,
+                       compareMapKeyElements compareKeyElements,
+                       int inline_key_size)
+{
+    Map map = malloc(sizeof(*map));
+    NodeStore store = malloc(sizeof(*store));
+    if (map == NULL || store == NULL)
+    {
+        free(map);
+        free(store);
+        return NULL;
+    }
+    map->copyData = copyDataElement;
+    map->copyKey = copyKeyElement;
+    map->freeData = freeDataElement;
+    map->freeKey = freeKeyElement;
+    map->compareKey = compareKeyElements;
+    map->inline_key_size = inline_key_size;
+    map->key_stride = inline_key_size > 0 ? (size_t)inline_key_size : sizeof(MapKeyElement);
+    nodePoolInit(&store->leaf_pool, sizeof(struct leaf_t) + NODE_CAPACITY * map->key_stride);
+    nodePoolInit(&store->internal_pool, sizeof(struct internal_t) + NODE_CAPACITY * map->key_stride);
+    store->holders = NULL;
+    store->references = 1;
+    map->store = store;
+    map->root = NULL;
+    map->iterator.map = NULL;
+    map->counter = 0;
+    map->int_keys = false;
+    map->table = NULL;
+#ifdef MAP_STATISTICS
+    memset(&map->statistics, 0, sizeof(map->statistics));
+#endif
+    return map;
+}
+
+/** Creates an empty map with the same element functions and key storage as map */
+static Map mapCreateLike(Map map)
+{
+    return mapAllocate(map->copyData, map->copyKey, map->freeData, map->freeKey,
+                       map->compareKey, map->inline_key_size);
+}
+
+static Leaf leafCreate(Map map)
+{
+    Leaf leaf = nodePoolAlloc(&map->store->leaf_pool);
+    if (leaf == NULL)
+    {
+        return NULL;
+    }
+    leaf->node.is_leaf = true;
+    leaf->node.size = 0;
+    leaf->node.references = 1;
+    return leaf;
+}
+
+static Internal internalCreate(Map map)
+{
+    Internal internal = nodePoolAlloc(&map->store->internal_pool);
+    if (internal == NULL)
+    {
+        return NULL;
+    }
+    internal->node.is_leaf = false;
+    internal->node.size = 0;
+    internal->node.references = 1;
+    return internal;
+}
+
+static void nodeFree(Map map, Node node)
+{
+    nodePoolFree(node->is_leaf ? &map->store->leaf_pool : &map->store->internal_pool, node);
+}
+
+/** Frees the keys of node, and the data elements if it is a leaf */
+static void nodeFreeEntries(Map map, Node node)
+{
+    for (int i = 0; i < node->size; i++)
+    {
+        nodeFreeKey(map, node, i);
+    }
+    if (node->is_leaf)
+    {
+        Leaf leaf = (Leaf)node;
+        for (int i = 0; i < node->size; i++)
+        {
+            MAP_FREE_DATA(map, leaf->data[i]);
+        }
+    }
+}
+
+/** Frees the key and data elements under node. The nodes go with their pools */
+static void nodeReleaseElements(Map map, Node node)
+{
+    if (node == NULL)
+    {
+        return;
+    }
+    nodeFreeEntries(map, node);
+    if (!node->is_leaf)
+    {
+        Internal internal = (Internal)node;
+        for (int i = 0; i <= node->size; i++)
+        {
+            nodeReleaseElements(map, internal->children[i]);
+        }
+    }
+}
+
+/** Drops a reference to node, freeing it and its elements once it is unused */
+static void nodeRelease(Map map, Node node)
+{
+    if (node == NULL || --node->references > 0)
+    {
+        return;
+    }
+    nodeFreeEntries(map, node);
+    if (!node->is_leaf)
+    {
+        Internal internal = (Internal)node;
+        for (int i = 0; i <= node->size; i++)
+        {
+            nodeRelease(map, internal->children[i]);
+        }
+    }
+    nodeFree(map, node);
+}
+
+/**
+ * Drops the reference of the map to its tree. Unless a snapshot shares the
+ * pools, every node belongs to this map alone and the pools are released at
+ * once instead of node by node.
+ */
+static void treeRelease(Map map)
+{
+    if (map->store->references == 1)
+    {
+        nodeReleaseElements(map, map->root);
+        nodePoolClear(&map->store->leaf_pool);
+        nodePoolClear(&map->store->internal_pool);
+    }
+    else
+    {
+        nodeRelease(map, map->root);
+    }
+    map->root = NULL;
+}
+
+/** Adds a holder to an element which a copied node shares with the node it copies */
+static bool elementRetain(Map map, void *element)
+{
+    NodeStore store = map->store;
+    if (store->holders == NULL)
+    {
+        store->holders = elementHoldersCreate();
+        if (store->holders == NULL)
+        {
+            return false;
+        }
+    }
+    int slot = elementHoldersProbe(store->holders, (uintptr_t)element);
+    if (store->holders->slots[slot].order != 0)
+    {
+        store->holders->slots[slot].value++;
+        return true;
+    }
+    return elementHoldersInsertAt(store->holders, slot, (uintptr_t)element, 1) == MAP_SUCCESS;
+}
+
+/** Drops a holder of an element, returns true if it was the last one and the element is to be freed */
+static bool elementRelease(Map map, void *element)
+{
+    ElementHolders holders = map->store->holders;
+    if (holders == NULL || holders->size == 0)
+    {
+        return true;
+    }
+    int slot = elementHoldersProbe(holders, (uintptr_t)element);
+    if (holders->slots[slot].order == 0)
+    {
+        return true;
+    }
+    if (--holders->slots[slot].value == 0)
+    {
+        elementHoldersRemoveAt(holders, slot);
+    }
+    return false;
+}
+
+/** Returns a copy of node sharing its elements and its children */
+static Node nodeClone(Map map, Node node)
+{
+    Node copy = node->is_leaf ? (Node)leafCreate(map) : (Node)internalCreate(map);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    for (; copy->size < node->size; copy->size++)
+    {
+        int index = copy->size;
+        if (map->inline_key_size == 0 && !elementRetain(map, nodeKey(map, node, index)))
+        {
+            break;
+        }
+        nodeMoveKeys(map, copy, index, node, index, 1);
+        if (node->is_leaf)
+        {
+            if (!elementRetain(map, ((Leaf)node)->data[index]))
+            {
+                nodeFreeKey(map, copy, index);
+                break;
+            }
+            ((Leaf)copy)->data[index] = ((Leaf)node)->data[index];
+        }
+    }
+    if (copy->size < node->size)
+    {
+        nodeFreeEntries(map, copy);
+        nodeFree(map, copy);
+        return NULL;
+    }
+    if (!node->is_leaf)
+    {
+        for (int i = 0; i <= node->size; i++)
+        {
+            Node child = ((Internal)node)->children[i];
+            child->references++;
+            ((Internal)copy)->children[i] = child;
+        }
+    }
+    return copy;
+}
+
+/**
+ * Makes sure the node *reference points to is used by this map alone,
+ * replacing it with a copy if it is shared with a snapshot.
+ */
+static bool nodeUnshare(Map map, Node *reference)
+{
+    if ((*reference)->references == 1)
+    {
+        return true;
+    }
+    Node copy = nodeClone(map, *reference);
+    if (copy == NULL)
+    {
+        return false;
+    }
+    (*reference)->references--;
+    *reference = copy;
+    return true;
+}
+
+static unsigned char *nodeKeySlot(Map map, Node node, int index)
+{
+    unsigned char *keys = node->is_leaf ? (unsigned char *)((Leaf)node)->keys
+                                        : (unsigned char *)((Internal)node)->keys;
+    return keys + (size_t)index * map->key_stride;
+}
+
+static MapKeyElement nodeKey(Map map, Node node, int index)
+{
+    unsigned char *slot = nodeKeySlot(map, node, index);
+    if (map->inline_key_size > 0)
+    {
+        return slot;
+    }
+    MapKeyElement key;
+    memcpy(&key, slot, sizeof(key));
+    return key;
+}
+
+static void nodeMoveKeys(Map map, Node destination, int destination_index,
+                         Node source, int source_index, int count)
+{
+    if (count > 0)
+    {
+        memmove(nodeKeySlot(map, destination, destination_index),
+                nodeKeySlot(map, source, source_index), (size_t)count * map->key_stride);
+    }
+}
+
+static void nodeSetKey(Map map, Node node, int index, StoredKey *stored)
+{
+    memcpy(nodeKeySlot(map, node, index), stored, map->key_stride);
+}
+
+static void nodeFreeKey(Map map, Node node, int index)
+{
+    if (map->inline_key_size == 0)
+    {
+        MAP_FREE_KEY(map, nodeKey(map, node, index));
+    }
+}
+
+/** Makes an owned copy of key, in the form keys are stored in the nodes */
+static bool storedKeyCreate(Map map, MapKeyElement key, StoredKey *stored)
+{
+    if (map->inline_key_size > 0)
+    {
+        memcpy(stored->bytes, key, map->inline_key_size);
+        return true;
+    }
+    stored->pointer = MAP_COPY_KEY(map, key);
+    return stored->pointer != NULL;
+}
+
+static void storedKeyDestroy(Map map, StoredKey *stored)
+{
+    if (map->inline_key_size == 0)
+    {
+        MAP_FREE_KEY(map, stored->pointer);
+    }
+}
+
+/** Returns a copy of key which the caller frees, as mapGetFirst promises */
+static MapKeyElement keyElementCopy(Map map, MapKeyElement key)
+{
+    if (map->inline_key_size == 0)
+    {
+        return MAP_COPY_KEY(map, key);
+    }
+    MapKeyElement copy = malloc(map->inline_key_size);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    memcpy(copy, key, map->inline_key_size);
+    return copy;
+}
+
+/** Returns the index of the first key in node which is not smaller than key */
+static int nodeLowerBound(Map map, Node node, MapKeyElement key)
+{
+    int low = 0, high = node->size;
+    while (low < high)
+    {
+        int middle = low + (high - low) / 2;
+        if (MAP_COMPARE_KEYS(map, nodeKey(map, node, middle), key) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/** Returns the index of the child whose subtree may hold key */
+static int internalChildIndex(Map map, Internal internal, MapKeyElement key)
+{
+    int low = 0, high = internal->node.size;
+    while (low < high)
+    {
+        int middle = low + (high - low) / 2;
+        if (MAP_COMPARE_KEYS(map, nodeKey(map, &internal->node, middle), key) <= 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static bool findKey(Map map, MapKeyElement keyElement, Leaf *leaf, int *index)
+{
+    if (map == NULL || keyElement == NULL || map->root == NULL)
+    {
+        return false;
+    }
+    Node node = map->root;
+    MAP_COUNT(map, nodes_visited);
+    while (!node->is_leaf)
+    {
+        node = ((Internal)node)->children[internalChildIndex(map, (Internal)node, keyElement)];
+        MAP_COUNT(map, nodes_visited);
+    }
+    int position = nodeLowerBound(map, node, keyElement);
+    if (position == node->size || MAP_COMPARE_KEYS(map, nodeKey(map, node, position), keyElement) != 0)
+    {
+        return false;
+    }
+    *leaf = (Leaf)node;
+    *index = position;
+    return true;
+}
+
+/** Splits the full child at parent->children[index] into two halves */
+static MapResult splitChild(Map map, Internal parent, int index)
+{
+    Node child = parent->children[index];
+    Node sibling;
+    StoredKey separator;
+    if (child->is_leaf)
+    {
+        Leaf leaf = (Leaf)child;
+        Leaf right = leafCreate(map);
+        if (right == NULL)
+        {
+            return MAP_OUT_OF_MEMORY;
+        }
+        if (!storedKeyCreate(map, nodeKey(map, child, NODE_MIDDLE), &separator))
+        {
+            nodeFree(map, &right->node);
+            return MAP_OUT_OF_MEMORY;
+        }
+        right->node.size = child->size - NODE_MIDDLE;
+        nodeMoveKeys(map, &right->node, 0, child, NODE_MIDDLE, right->node.size);
+        memcpy(right->data, leaf->data + NODE_MIDDLE, sizeof(MapDataElement) * right->node.size);
+        child->size = NODE_MIDDLE;
+        sibling = (Node)right;
+    }
+    else
+    {
+        Internal internal = (Internal)child;
+        Internal right = internalCreate(map);
+        if (right == NULL)
+        {
+            return MAP_OUT_OF_MEMORY;
+        }
+        memcpy(&separator, nodeKeySlot(map, child, NODE_MIDDLE), map->key_stride);
+        right->node.size = child->size - NODE_MIDDLE - 1;
+        nodeMoveKeys(map, &right->node, 0, child, NODE_MIDDLE + 1, right->node.size);
+        memcpy(right->children, internal->children + NODE_MIDDLE + 1, sizeof(Node) * (right->node.size + 1));
+        child->size = NODE_MIDDLE;
+        sibling = (Node)right;
+    }
+    Node parent_node = &parent->node;
+    nodeMoveKeys(map, parent_node, index + 1, parent_node, index, parent_node->size - index);
+    memmove(parent->children + index + 2, parent->children + index + 1,
+            sizeof(Node) * (parent_node->size - index));
+    nodeSetKey(map, parent_node, index, &separator);
+    parent->children[index + 1] = sibling;
+    parent_node->size++;
+    return MAP_SUCCESS;
+}
+
+/** Moves the last pair of the left sibling into parent->children[index] */
+static MapResult borrowFromLeft(Map map, Internal parent, int index)
+{
+    Node child = parent->children[index];
+    Node left = parent->children[index - 1];
+    StoredKey separator;
+    if (child->is_leaf && !storedKeyCreate(map, nodeKey(map, left, left->size - 1), &separator))
+    {
+        return MAP_OUT_OF_MEMORY;
+    }
+    nodeMoveKeys(map, child, 1, child, 0, child->size);
+    if (child->is_leaf)
+    {
+        Leaf child_leaf = (Leaf)child;
+        memmove(child_leaf->data + 1, child_leaf->data, sizeof(MapDataElement) * child->size);
+        nodeMoveKeys(map, child, 0, left, left->size - 1, 1);
+        child_leaf->data[0] = ((Leaf)left)->data[left->size - 1];
+        nodeFreeKey(map, &parent->node, index - 1);
+        nodeSetKey(map, &parent->node, index - 1, &separator);
+    }
+    else
+    {
+        Internal child_internal = (Internal)child;
+        memmove(child_internal->children + 1, child_internal->children, sizeof(Node) * (child->size + 1));
+        nodeMoveKeys(map, child, 0, &parent->node, index - 1, 1);
+        child_internal->children[0] = ((Internal)left)->children[left->size];
+        nodeMoveKeys(map, &parent->node, index - 1, left, left->size - 1, 1);
+    }
+    left->size--;
+    child->size++;
+    return MAP_SUCCESS;
+}
+
+/** Moves the first pair of the right sibling into parent->children[index] */
+static MapResult borrowFromRight(Map map, Internal parent, int index)
+{
+    Node child = parent->children[index];
+    Node right = parent->children[index + 1];
+    if (child->is_leaf)
+    {
+        StoredKey separator;
+        if (!storedKeyCreate(map, nodeKey(map, right, 1), &separator))
+        {
+            return MAP_OUT_OF_MEMORY;
+        }
+        Leaf right_leaf = (Leaf)right;
+        nodeMoveKeys(map, child, child->size, right, 0, 1);
+        ((Leaf)child)->data[child->size] = right_leaf->data[0];
+        memmove(right_leaf->data, right_leaf->data + 1, sizeof(MapDataElement) * (right->size - 1));
+        nodeFreeKey(map, &parent->node, index);
+        nodeSetKey(map, &parent->node, index, &separator);
+    }
+    else
+    {
+        Internal right_internal = (Internal)right;
+        nodeMoveKeys(map, child, child->size, &parent->node, index, 1);
+        ((Internal)child)->children[child->size + 1] = right_internal->children[0];
+        nodeMoveKeys(map, &parent->node, index, right, 0, 1);
+        memmove(right_internal->children, right_internal->children + 1, sizeof(Node) * right->size);
+    }
+    nodeMoveKeys(map, right, 0, right, 1, right->size - 1);
+    right->size--;
+    child->size++;
+    return MAP_SUCCESS;
+}
+
+/** Merges parent->children[index + 1] into parent->children[index] */
+static void mergeChildren(Map map, Internal parent, int index)
+{
+    Node left = parent->children[index];
+    Node right = parent->children[index + 1];
+    if (left->is_leaf)
+    {
+        nodeMoveKeys(map, left, left->size, right, 0, right->size);
+        memcpy(((Leaf)left)->data + left->size, ((Leaf)right)->data, sizeof(MapDataElement) * right->size);
+        left->size += right->size;
+        nodeFreeKey(map, &parent->node, index);
+    }
+    else
+    {
+        nodeMoveKeys(map, left, left->size, &parent->node, index, 1);
+        nodeMoveKeys(map, left, left->size + 1, right, 0, right->size);
+        memcpy(((Internal)left)->children + left->size + 1, ((Internal)right)->children,
+               sizeof(Node) * (right->size + 1));
+        left->size += right->size + 1;
+    }
+    nodeFree(map, right);
+    Node parent_node = &parent->node;
+    nodeMoveKeys(map, parent_node, index, parent_node, index + 1, parent_node->size - index - 1);
+    memmove(parent->children + index + 1, parent->children + index + 2,
+            sizeof(Node) * (parent_node->size - index - 1));
+    parent_node->size--;
+}
 
-Node createNode(Map map, MapDataElement data, MapKeyElement key,
-                Node previous, Node next)
+/**
+ * Makes sure parent->children[*index] has more than the minimal number of
+ * keys, so a removal inside its subtree cannot leave it too thin.
+ * The child must already be used by this map alone, the sibling it takes
+ * keys from is unshared here.
+ * index is updated if the child was merged into its left sibling.
+ */
+static MapResult fixChild(Map map, Internal parent, int *index)
 {
-    Node new_node = malloc(sizeof(*new_node));
-    if (new_node == NULL)
+    Node left = *index > 0 ? parent->children[*index - 1] : NULL;
+    Node right = *index < parent->node.size ? parent->children[*index + 1] : NULL;
+    if (left != NULL && left->size > NODE_MIN_KEYS)
+    {
+        if (!nodeUnshare(map, &parent->children[*index - 1]))
+        {
+            return MAP_OUT_OF_MEMORY;
+        }
+        return borrowFromLeft(map, parent, *index);
+    }
+    if (right != NULL && right->size > NODE_MIN_KEYS)
+    {
+        if (!nodeUnshare(map, &parent->children[*index + 1]))
+        {
+            return MAP_OUT_OF_MEMORY;
+        }
+        return borrowFromRight(map, parent, *index);
+    }
+    int merged = left != NULL ? *index - 1 : *index;
+    if (!nodeUnshare(map, &parent->children[merged]) ||
+        !nodeUnshare(map, &parent->children[merged + 1]))
+    {
+        return MAP_OUT_OF_MEMORY;
+    }
+    *index = merged;
+    mergeChildren(map, parent, *index);
+    return MAP_SUCCESS;
+}
+
+static MapKeyElement copyIntKey(MapKeyElement key)
+{
+    int *copy = malloc(sizeof(*copy));
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    *copy = *(int *)key;
+    return copy;
+}
+
+static void freeIntKey(MapKeyElement key)
+{
+    free(key);
+}
+
+static int compareIntKeys(MapKeyElement key_1, MapKeyElement key_2)
+{
+    int first = *(int *)key_1, second = *(int *)key_2;
+    return (first > second) - (first < second);
+}
+
+/** Frees table and its data elements */
+static void intMapRelease(Map map, IntTable table)
+{
+    if (table == NULL)
+    {
+        return;
+    }
+    for (int i = 0; i < table->capacity; i++)
+    {
+        if (table->slots[i].order != 0)
+        {
+            MAP_FREE_DATA(map, table->slots[i].value);
+        }
+    }
+    intTableDestroy(table);
+}
+
+/** Returns the slot holding key, or the empty slot where it would be placed */
+static int intMapFind(Map map, int key)
+{
+    int slot = intTableProbe(map->table, key);
+#ifdef MAP_STATISTICS
+    map->statistics.probes += ((slot - intTableHome(map->table, key)) & (map->table->capacity - 1)) + 1;
+#endif
+    return slot;
+}
+
+/** Returns the data element to store: dataElement itself if taken, else a copy */
+static MapDataElement newDataElement(Map map, MapDataElement dataElement, bool take_data)
+{
+    return take_data ? dataElement : MAP_COPY_DATA(map, dataElement);
+}
+
+static void replaceDataElement(Map map, MapDataElement *stored, MapDataElement new_data)
+{
+    if (*stored != new_data)
+    {
+        MAP_FREE_DATA(map, *stored);
+        *stored = new_data;
+    }
+}
+
+static MapResult intMapPut(Map map, int key, MapDataElement dataElement, bool take_data)
+{
+    int slot = intMapFind(map, key);
+    MapDataElement new_data = newDataElement(map, dataElement, take_data);
+    if (new_data == NULL)
+    {
+        return MAP_OUT_OF_MEMORY;
+    }
+    if (map->table->slots[slot].order != 0)
+    {
+        replaceDataElement(map, &map->table->slots[slot].value, new_data);
+        return MAP_SUCCESS;
+    }
+    if (intTableInsertAt(map->table, slot, key, new_data) != MAP_SUCCESS)
+    {
+        if (!take_data)
+        {
+            MAP_FREE_DATA(map, new_data);
+        }
+        return MAP_OUT_OF_MEMORY;
+    }
+    map->counter++;
+    return MAP_SUCCESS;
+}
+
+static MapResult intMapRemove(Map map, int key)
+{
+    int slot = intMapFind(map, key);
+    if (map->table->slots[slot].order == 0)
+    {
+        return MAP_ITEM_DOES_NOT_EXIST;
+    }
+    MAP_FREE_DATA(map, map->table->slots[slot].value);
+    intTableRemoveAt(map->table, slot);
+    map->counter--;
+    return MAP_SUCCESS;
+}
+
+static void intMapClear(Map map)
+{
+    for (int i = 0; i < map->table->capacity; i++)
+    {
+        if (map->table->slots[i].order != 0)
+        {
+            MAP_FREE_DATA(map, map->table->slots[i].value);
+        }
+    }
+    intTableClear(map->table);
+    map->counter = 0;
+}
+
+/** Returns a copy of the map's table, slot for slot, with copies of the data elements */
+static IntTable intMapCopyTable(Map map)
+{
+    IntTable table = intTableCopy(map->table);
+    if (table == NULL)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < table->capacity; i++)
+    {
+        if (table->slots[i].order != 0)
+        {
+            table->slots[i].value = MAP_COPY_DATA(map, table->slots[i].value);
+            if (table->slots[i].value == NULL)
+            {
+                for (int j = i; j < table->capacity; j++)
+                {
+                    table->slots[j].order = 0;
+                }
+                intMapRelease(map, table);
+                return NULL;
+            }
+        }
+    }
+    return table;
+}
+
+/** Returns the smallest key stored under node */
+static MapKeyElement subtreeFirstKey(Map map, Node node)
+{
+    while (!node->is_leaf)
+    {
+        node = ((Internal)node)->children[0];
+    }
+    return nodeKey(map, node, 0);
+}
+
+/**
+ * Frees the nodes and separator keys under node. The pairs in the leaves are
+ * left to whoever owns them.
+ */
+static void nodeFreeStructure(Map map, Node node)
+{
+    if (!node->is_leaf)
+    {
+        Internal internal = (Internal)node;
+        for (int i = 0; i < node->size; i++)
+        {
+            nodeFreeKey(map, node, i);
+        }
+        for (int i = 0; i <= node->size; i++)
+        {
+            nodeFreeStructure(map, internal->children[i]);
+        }
+    }
+    nodeFree(map, node);
+}
+
+/** Frees a partially built tree given as a forest of subtrees */
+static void treeBuildAbort(Map map, Node *forest, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        nodeFreeStructure(map, forest[i]);
+    }
+}
+
+/**
+ * Builds a tree from entries sorted by strictly ascending keys in O(n): the
+ * leaves are filled evenly from left to right, then every level of internal
+ * nodes is built over the one below it.
+ * On success the tree owns the elements of the entries. On failure they
+ * still belong to the caller and nothing else is left allocated.
+ */
+static MapResult treeBuildEntries(Map map, TreeEntry entries, int size, Node *root)
+{
+    *root = NULL;
+    if (size == 0)
+    {
+        return MAP_SUCCESS;
+    }
+    int level_size = (size + NODE_CAPACITY - 1) / NODE_CAPACITY;
+    Node *level = malloc(sizeof(*level) * level_size);
+    if (level == NULL)
+    {
+        return MAP_OUT_OF_MEMORY;
+    }
+    int position = 0;
+    for (int i = 0; i < level_size; i++)
+    {
+        Leaf leaf = leafCreate(map);
+        if (leaf == NULL)
+        {
+            treeBuildAbort(map, level, i);
+            free(level);
+            return MAP_OUT_OF_MEMORY;
+        }
+        level[i] = &leaf->node;
+        int leaf_size = size / level_size + (i < size % level_size ? 1 : 0);
+        for (int j = 0; j < leaf_size; j++, position++)
+        {
+            nodeSetKey(map, &leaf->node, j, &entries[position].key);
+            leaf->data[j] = entries[position].data;
+        }
+        leaf->node.size = leaf_size;
+    }
+    while (level_size > 1)
+    {
+        int parents = (level_size + NODE_CAPACITY) / (NODE_CAPACITY + 1);
+        int child = 0;
+        for (int i = 0; i < parents; i++)
+        {
+            Internal internal = internalCreate(map);
+            if (internal == NULL)
+            {
+                memmove(level + i, level + child, sizeof(*level) * (level_size - child));
+                treeBuildAbort(map, level, i + level_size - child);
+                free(level);
+                return MAP_OUT_OF_MEMORY;
+            }
+            int children = level_size / parents + (i < level_size % parents ? 1 : 0);
+            internal->children[0] = level[child++];
+            for (int j = 1; j < children; j++, child++)
+            {
+                StoredKey separator;
+                if (!storedKeyCreate(map, subtreeFirstKey(map, level[child]), &separator))
+                {
+                    level[i] = &internal->node;
+                    memmove(level + i + 1, level + child, sizeof(*level) * (level_size - child));
+                    treeBuildAbort(map, level, i + 1 + level_size - child);
+                    free(level);
+                    return MAP_OUT_OF_MEMORY;
+                }
+                nodeSetKey(map, &internal->node, j - 1, &separator);
+                internal->children[j] = level[child];
+                internal->node.size++;
+            }
+            level[i] = &internal->node;
+        }
+        level_size = parents;
+    }
+    *root = level[0];
+    free(level);
+    return MAP_SUCCESS;
+}
+
+/** Makes an entry owning copies of key and data */
+static bool treeEntryCreate(Map map, MapKeyElement key, MapDataElement data, TreeEntry entry)
+{
+    if (!storedKeyCreate(map, key, &entry->key))
+    {
+        return false;
+    }
+    entry->data = MAP_COPY_DATA(map, data);
+    if (entry->data == NULL)
+    {
+        storedKeyDestroy(map, &entry->key);
+        return false;
+    }
+    return true;
+}
+
+static void treeEntriesDestroy(Map map, TreeEntry entries, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        storedKeyDestroy(map, &entries[i].key);
+        MAP_FREE_DATA(map, entries[i].data);
+    }
+}
+
+/** Fills the tree of an empty map with copies of pairs sorted by strictly ascending keys */
+static MapResult treeBuildSorted(Map map, MapKeyElement *keys, MapDataElement *data, int size)
+{
+    TreeEntry entries = malloc(sizeof(*entries) * (size + 1));
+    if (entries == NULL)
+    {
+        return MAP_OUT_OF_MEMORY;
+    }
+    for (int i = 0; i < size; i++)
+    {
+        if (!treeEntryCreate(map, keys[i], data[i], &entries[i]))
+        {
+            treeEntriesDestroy(map, entries, i);
+            free(entries);
+            return MAP_OUT_OF_MEMORY;
+        }
+    }
+    MapResult result = treeBuildEntries(map, entries, size, &map->root);
+    if (result == MAP_SUCCESS)
+    {
+        map->counter = size;
+    }
+    else
+    {
+        treeEntriesDestroy(map, entries, size);
+    }
+    free(entries);
+    return result;
+}
+
+static MapResult intMapBuildSorted(Map map, MapKeyElement *keys, MapDataElement *data, int size)
+{
+    if (intTableReserve(map->table, size) != MAP_SUCCESS)
+    {
+        return MAP_OUT_OF_MEMORY;
+    }
+    for (int i = 0; i < size; i++)
+    {
+        if (intMapPut(map, *(int *)keys[i], data[i], false) != MAP_SUCCESS)
+        {
+            intMapClear(map);
+            return MAP_OUT_OF_MEMORY;
+        }
+    }
+    return MAP_SUCCESS;
+}
+
+/**
+ * Sorts pairs by key with a stable merge sort, then keeps only the last of
+ * the pairs sharing a key, as putting them one by one would.
+ * Returns the number of pairs left at the start of pairs.
+ */
+static int batchSortUnique(Map map, BatchPair pairs, BatchPair buffer, int size)
+{
+    bool sorted = true;
+    for (int i = 1; i < size && sorted; i++)
+    {
+        sorted = MAP_COMPARE_KEYS(map, pairs[i - 1].key, pairs[i].key) < 0;
+    }
+    if (sorted)
+    {
+        return size;
+    }
+    BatchPair source = pairs, target = buffer;
+    for (int width = 1; width < size; width *= 2)
+    {
+        for (int low = 0; low < size; low += 2 * width)
+        {
+            int middle = low + width < size ? low + width : size;
+            int high = low + 2 * width < size ? low + 2 * width : size;
+            int left = low, right = middle;
+            for (int i = low; i < high; i++)
+            {
+                if (right < high && (left == middle || MAP_COMPARE_KEYS(map, source[right].key, source[left].key) < 0))
+                {
+                    target[i] = source[right++];
+                }
+                else
+                {
+                    target[i] = source[left++];
+                }
+            }
+        }
+        BatchPair merged = target;
+        target = source;
+        source = merged;
+    }
+    int unique = 0;
+    for (int i = 0; i < size; i++)
+    {
+        if (i + 1 == size || MAP_COMPARE_KEYS(map, source[i].key, source[i + 1].key) != 0)
+        {
+            pairs[unique++] = source[i];
+        }
+    }
+    return unique;
+}
+
+/**
+ * Merges sorted pairs with unique keys into the tree. The pairs of the map
+ * are moved, not copied, into a tree rebuilt in one pass, and the old nodes
+ * are freed only once the new tree is complete, so a failure leaves the map
+ * unchanged.
+ */
+static MapResult treePutBatch(Map map, BatchPair pairs, int size)
+{
+    if (map->store->references > 1 || size * BATCH_REBUILD_RATIO < map->counter)
+    {
+        for (int i = 0; i < size; i++)
+        {
+            if (treePut(map, pairs[i].key, pairs[i].data, false) != MAP_SUCCESS)
+            {
+                return MAP_OUT_OF_MEMORY;
+            }
+        }
+        return MAP_SUCCESS;
+    }
+    int total = map->counter + size;
+    TreeEntry entries = malloc(sizeof(*entries) * total);
+    EntryOrigin *origins = malloc(sizeof(*origins) * total);
+    MapDataElement *replaced = malloc(sizeof(*replaced) * size);
+    if (entries == NULL || origins == NULL || replaced == NULL)
+    {
+        free(entries);
+        free(origins);
+        free(replaced);
+        return MAP_OUT_OF_MEMORY;
+    }
+    MapResult result = MAP_SUCCESS;
+    int count = 0, replaced_count = 0, next = 0;
+    MapCursor cursor = mapCursorFirst(map);
+    while (mapCursorIsValid(&cursor) || next < size)
+    {
+        TreeEntry entry = &entries[count];
+        int order = !mapCursorIsValid(&cursor) ? 1 : next == size ? -1
+                    : MAP_COMPARE_KEYS(map, mapCursorGetKey(&cursor), pairs[next].key);
+        if (order <= 0)
+        {
+            Leaf leaf = cursor.path[cursor.depth - 1];
+            int index = cursor.indexes[cursor.depth - 1];
+            memcpy(&entry->key, nodeKeySlot(map, &leaf->node, index), map->key_stride);
+            entry->data = leaf->data[index];
+            origins[count] = ENTRY_MOVED;
+            if (order == 0)
+            {
+                entry->data = MAP_COPY_DATA(map, pairs[next].data);
+                if (entry->data == NULL)
+                {
+                    result = MAP_OUT_OF_MEMORY;
+                    break;
+                }
+                replaced[replaced_count++] = leaf->data[index];
+                origins[count] = ENTRY_NEW_DATA;
+                next++;
+            }
+            mapCursorNext(&cursor);
+        }
+        else
+        {
+            if (!treeEntryCreate(map, pairs[next].key, pairs[next].data, entry))
+            {
+                result = MAP_OUT_OF_MEMORY;
+                break;
+            }
+            origins[count] = ENTRY_NEW;
+            next++;
+        }
+        count++;
+    }
+    Node root = NULL;
+    if (result == MAP_SUCCESS)
+    {
+        result = treeBuildEntries(map, entries, count, &root);
+    }
+    if (result == MAP_SUCCESS)
+    {
+        for (int i = 0; i < replaced_count; i++)
+        {
+            MAP_FREE_DATA(map, replaced[i]);
+        }
+        if (map->root != NULL)
+        {
+            nodeFreeStructure(map, map->root);
+        }
+        map->root = root;
+        map->counter = count;
+    }
+    else
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (origins[i] != ENTRY_MOVED)
+            {
+                MAP_FREE_DATA(map, entries[i].data);
+            }
+            if (origins[i] == ENTRY_NEW)
+            {
+                storedKeyDestroy(map, &entries[i].key);
+            }
+        }
+    }
+    free(entries);
+    free(origins);
+    free(replaced);
+    return result;
+}
+
+/** Puts sorted pairs into an int table, growing it once for the whole batch */
+static MapResult intMapPutBatch(Map map, BatchPair pairs, int size)
+{
+    if (size > INT_MAX - map->counter || intTableReserve(map->table, map->counter + size) != MAP_SUCCESS)
+    {
+        return MAP_OUT_OF_MEMORY;
+    }
+    for (int i = 0; i < size; i++)
+    {
+        if (intMapPut(map, *(int *)pairs[i].key, pairs[i].data, false) != MAP_SUCCESS)
+        {
+            return MAP_OUT_OF_MEMORY;
+        }
+    }
+    return MAP_SUCCESS;
+}
+
+Map mapCreate(copyMapDataElements copyDataElement,
+              copyMapKeyElements copyKeyElement,
+              freeMapDataElements freeDataElement,
+              freeMapKeyElements freeKeyElement,
+              compareMapKeyElements compareKeyElements)
+{
+    if (copyDataElement == NULL || copyKeyElement == NULL ||
+        freeDataElement == NULL || freeKeyElement == NULL ||
+        compareKeyElements == NULL)
+    {
+        return NULL;
+    }
+    return mapAllocate(copyDataElement, copyKeyElement, freeDataElement, freeKeyElement,
+                       compareKeyElements, 0);
+}
+
+Map mapCreateInline(copyMapDataElements copyDataElement,
+                    freeMapDataElements freeDataElement,
+                    compareMapKeyElements compareKeyElements,
+                    int key_size)
+{
+    if (copyDataElement == NULL || freeDataElement == NULL || compareKeyElements == NULL ||
+        key_size <= 0 || key_size > MAP_MAX_INLINE_KEY_SIZE)
+    {
+        return NULL;
+    }
+    return mapAllocate(copyDataElement, NULL, freeDataElement, free, compareKeyElements, key_size);
+}
+
+Map mapCreateInt(copyMapDataElements copyDataElement,
+                 freeMapDataElements freeDataElement)
+{
+    Map map = mapCreate(copyDataElement, copyIntKey, freeDataElement, freeIntKey, compareIntKeys);
+    if (map == NULL)
+    {
+        return NULL;
+    }
+    map->int_keys = true;
+    map->table = intTableCreate();
+    if (map->table == NULL)
+    {
+        mapDestroy(map);
+        return NULL;
+    }
+    return map;
+}
+
+void mapDestroy(Map map)
+{
+    if (map == NULL)
+    {
+        return;
+    }
+    if (map->int_keys)
     {
-        return NULL;
+        intMapRelease(map, map->table);
     }
-    new_node->data = map->copyData(data);
-    if (new_node->data == NULL)
+    else
     {
-        free(new_node);
-        return NULL;
+        treeRelease(map);
     }
-    new_node->key = map->copyKey(key);
-    if (new_node->key == NULL)
+    if (--map->store->references == 0)
     {
-        map->freeData(new_node->data);
-        free(new_node);
-        return NULL;
+        nodePoolClear(&map->store->leaf_pool);
+        nodePoolClear(&map->store->internal_pool);
+        elementHoldersDestroy(map->store->holders);
+        free(map->store);
     }
-    new_node->next = next;
-    new_node->previous = previous;
-    return new_node;
+    free(map);
 }
 
-Node findKey(Map map, MapKeyElement keyElement)
+Map mapCopy(Map map)
 {
-    if (map == NULL || keyElement == NULL)
+    if (map == NULL)
     {
         return NULL;
     }
-    map->current = map->first->next;
-    while (map->current != NULL)
+    map->iterator.map = NULL;
+    if (map->int_keys)
     {
-        if (map->compareKey(map->current->key, keyElement) == 0)
+        Map new_map = mapCreateInt(map->copyData, map->freeData);
+        IntTable table = new_map == NULL ? NULL : intMapCopyTable(map);
+        if (table == NULL)
         {
-            return map->current;
+            mapDestroy(new_map);
+            return NULL;
         }
-        map->current = map->current->next;
+        intTableDestroy(new_map->table);
+        new_map->table = table;
+        new_map->counter = map->counter;
+        return new_map;
+    }
+    Map new_map = mapCreateLike(map);
+    MapKeyElement *keys = malloc(sizeof(*keys) * (map->counter + 1));
+    MapDataElement *data = malloc(sizeof(*data) * (map->counter + 1));
+    if (new_map == NULL || keys == NULL || data == NULL)
+    {
+        mapDestroy(new_map);
+        free(keys);
+        free(data);
+        return NULL;
+    }
+    int position = 0;
+    MAP_CURSOR_FOREACH(cursor, map)
+    {
+        keys[position] = mapCursorGetKey(&cursor);
+        data[position] = mapCursorGetData(&cursor);
+        position++;
+    }
+    MapResult result = treeBuildSorted(new_map, keys, data, map->counter);
+    free(keys);
+    free(data);
+    if (result != MAP_SUCCESS)
+    {
+        mapDestroy(new_map);
+        return NULL;
     }
-    return NULL;
+    return new_map;
 }
 
-Map mapCreate(copyMapDataElements copyDataElement,
-              copyMapKeyElements copyKeyElement,
-              freeMapDataElements freeDataElement,
-              freeMapKeyElements freeKeyElement,
-              compareMapKeyElements compareKeyElements)
+Map mapSnapshot(Map map)
 {
-    if (copyDataElement == NULL || copyKeyElement == NULL ||
-        freeDataElement == NULL || freeKeyElement == NULL ||
-        compareKeyElements == NULL)
+    if (map == NULL)
     {
         return NULL;
     }
-    Map map = malloc(sizeof(*map));
-    if (map == NULL)
+    if (map->int_keys)
     {
         return NULL;
     }
-    map->copyData = copyDataElement;
-    map->copyKey = copyKeyElement;
-    map->freeData = freeDataElement;
-    map->freeKey = freeKeyElement;
-    map->compareKey = compareKeyElements;
-    map->first = malloc(sizeof(*map->first));
-    if (map->first == NULL)
+    Map snapshot = malloc(sizeof(*snapshot));
+    if (snapshot == NULL)
     {
-        free(map);
         return NULL;
     }
-    map->first->data = NULL;
-    map->first->key = NULL;
-    map->first->next = NULL;
-    map->first->previous = NULL;
-    map->current = map->first;
-    map->counter = 0;
-    return map;
+    *snapshot = *map;
+    snapshot->iterator.map = NULL;
+#ifdef MAP_STATISTICS
+    memset(&snapshot->statistics, 0, sizeof(snapshot->statistics));
+#endif
+    snapshot->store->references++;
+    if (map->root != NULL)
+    {
+        map->root->references++;
+    }
+    return snapshot;
 }
 
-void mapDestroy(Map map)
+MapResult mapBuildSorted(Map map, MapKeyElement *keys, MapDataElement *data, int size)
 {
-    if (map != NULL)
+    if (map == NULL || (size > 0 && (keys == NULL || data == NULL)))
     {
-        mapClear(map);
-        free(map->first);
-        free(map);
+        return MAP_NULL_ARGUMENT;
+    }
+    if (size < 0 || map->counter > 0)
+    {
+        return MAP_ERROR;
+    }
+    for (int i = 0; i < size; i++)
+    {
+        if (keys[i] == NULL || data[i] == NULL)
+        {
+            return MAP_NULL_ARGUMENT;
+        }
+        if (i > 0 && MAP_COMPARE_KEYS(map, keys[i - 1], keys[i]) >= 0)
+        {
+            return MAP_ERROR;
+        }
+    }
+    map->iterator.map = NULL;
+    if (map->int_keys)
+    {
+        return intMapBuildSorted(map, keys, data, size);
     }
+    treeRelease(map);
+    return treeBuildSorted(map, keys, data, size);
 }
 
-Map mapCopy(Map map)
+MapResult mapPutBatch(Map map, MapKeyElement *keys, MapDataElement *data, int size)
 {
-    if (map == NULL)
+    if (map == NULL || (size > 0 && (keys == NULL || data == NULL)))
     {
-        return NULL;
+        return MAP_NULL_ARGUMENT;
     }
-    Map new_map = mapCreate(map->copyData, map->copyKey,
-                            map->freeData, map->freeKey,
-                            map->compareKey);
-    if (new_map == NULL)
+    if (size < 0)
     {
-        return NULL;
+        return MAP_ERROR;
     }
-    MapResult put;
-    map->current = map->first->next;
-    while (map->current != NULL)
+    MAP_COUNT(map, batches);
+    for (int i = 0; i < size; i++)
     {
-        put = mapPut(new_map, map->current->key, map->current->data);
-        if (put != MAP_SUCCESS)
+        if (keys[i] == NULL || data[i] == NULL)
         {
-            mapDestroy(new_map);
-            return NULL;
+            return MAP_NULL_ARGUMENT;
         }
-        map->current = map->current->next;
     }
-    new_map->counter = map->counter;
-    return new_map;
+    map->iterator.map = NULL;
+    if (size == 0)
+    {
+        return MAP_SUCCESS;
+    }
+    BatchPair pairs = malloc(sizeof(*pairs) * size);
+    BatchPair buffer = malloc(sizeof(*buffer) * size);
+    if (pairs == NULL || buffer == NULL)
+    {
+        free(pairs);
+        free(buffer);
+        return MAP_OUT_OF_MEMORY;
+    }
+    for (int i = 0; i < size; i++)
+    {
+        pairs[i].key = keys[i];
+        pairs[i].data = data[i];
+    }
+    size = batchSortUnique(map, pairs, buffer, size);
+    free(buffer);
+    MapResult result = map->int_keys ? intMapPutBatch(map, pairs, size) : treePutBatch(map, pairs, size);
+    free(pairs);
+    return result;
 }
 
 int mapGetSize(Map map)
@@ -164,74 +1543,153 @@ bool mapContains(Map map, MapKeyElement element)
     {
         return false;
     }
-    return findKey(map, element) != NULL;
+    MAP_COUNT(map, contains);
+    map->iterator.map = NULL;
+    if (map->int_keys)
+    {
+        return map->table->slots[intMapFind(map, *(int *)element)].order != 0;
+    }
+    Leaf leaf;
+    int index;
+    return findKey(map, element, &leaf, &index);
 }
 
-MapResult mapPut(Map map, MapKeyElement keyElement, MapDataElement dataElement)
+static MapResult treePut(Map map, MapKeyElement keyElement, MapDataElement dataElement, bool take_data)
 {
-    if (map == NULL || keyElement == NULL || dataElement == NULL)
+    if (map->root == NULL)
     {
-        return MAP_NULL_ARGUMENT;
+        Leaf leaf = leafCreate(map);
+        if (leaf == NULL)
+        {
+            return MAP_OUT_OF_MEMORY;
+        }
+        map->root = (Node)leaf;
+    }
+    if (!nodeUnshare(map, &map->root))
+    {
+        return MAP_OUT_OF_MEMORY;
     }
-    map->current = findKey(map, keyElement);
-    if (map->current == NULL)
+    if (map->root->size == NODE_CAPACITY)
     {
-        map->current = map->first->next;
-        Node previous = map->first;
-        while (map->current != NULL)
+        Internal new_root = internalCreate(map);
+        if (new_root == NULL)
         {
-            if (map->compareKey(map->current->key, keyElement) > 0)
-            {
-                Node new_node = createNode(map, dataElement, keyElement,
-                                           map->current->previous, map->current);
-                if (new_node == NULL)
-                {
-                    return MAP_OUT_OF_MEMORY;
-                }
-                map->current->previous->next = new_node;
-                map->current->previous = new_node;
-                map->counter++;
-                return MAP_SUCCESS;
-            }
-            previous = map->current;
-            map->current = map->current->next;
+            return MAP_OUT_OF_MEMORY;
         }
-        map->current = createNode(map, dataElement, keyElement,
-                                  previous, NULL);
-        if (map->current == NULL)
+        new_root->children[0] = map->root;
+        if (splitChild(map, new_root, 0) != MAP_SUCCESS)
         {
+            nodeFree(map, &new_root->node);
             return MAP_OUT_OF_MEMORY;
         }
-        previous->next = map->current;
-        map->current = map->current->next; // move indicator
-        map->counter++;
+        map->root = (Node)new_root;
     }
-    else
+    Node node = map->root;
+    MAP_COUNT(map, nodes_visited);
+    while (!node->is_leaf)
+    {
+        Internal internal = (Internal)node;
+        int index = internalChildIndex(map, internal, keyElement);
+        if (!nodeUnshare(map, &internal->children[index]))
+        {
+            return MAP_OUT_OF_MEMORY;
+        }
+        if (internal->children[index]->size == NODE_CAPACITY)
+        {
+            if (splitChild(map, internal, index) != MAP_SUCCESS)
+            {
+                return MAP_OUT_OF_MEMORY;
+            }
+            if (MAP_COMPARE_KEYS(map, keyElement, nodeKey(map, node, index)) >= 0)
+            {
+                index++;
+            }
+        }
+        node = internal->children[index];
+        MAP_COUNT(map, nodes_visited);
+    }
+    Leaf leaf = (Leaf)node;
+    int position = nodeLowerBound(map, node, keyElement);
+    if (position < node->size && MAP_COMPARE_KEYS(map, nodeKey(map, node, position), keyElement) == 0)
     {
-        MapDataElement tmp_data = map->current->data;
-        map->current->data = map->copyData(dataElement);
-        if (map->current->data == NULL)
+        MapDataElement new_data = newDataElement(map, dataElement, take_data);
+        if (new_data == NULL)
         {
-            map->current->data = tmp_data;
             return MAP_OUT_OF_MEMORY;
         }
-        map->freeData(tmp_data);
+        replaceDataElement(map, &leaf->data[position], new_data);
+        return MAP_SUCCESS;
+    }
+    StoredKey new_key;
+    if (!storedKeyCreate(map, keyElement, &new_key))
+    {
+        return MAP_OUT_OF_MEMORY;
     }
+    MapDataElement new_data = newDataElement(map, dataElement, take_data);
+    if (new_data == NULL)
+    {
+        storedKeyDestroy(map, &new_key);
+        return MAP_OUT_OF_MEMORY;
+    }
+    nodeMoveKeys(map, node, position + 1, node, position, node->size - position);
+    memmove(leaf->data + position + 1, leaf->data + position,
+            sizeof(MapDataElement) * (node->size - position));
+    nodeSetKey(map, node, position, &new_key);
+    leaf->data[position] = new_data;
+    node->size++;
+    map->counter++;
     return MAP_SUCCESS;
 }
 
+MapResult mapPut(Map map, MapKeyElement keyElement, MapDataElement dataElement)
+{
+    if (map == NULL || keyElement == NULL || dataElement == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    MAP_COUNT(map, puts);
+    map->iterator.map = NULL;
+    if (map->int_keys)
+    {
+        return intMapPut(map, *(int *)keyElement, dataElement, false);
+    }
+    return treePut(map, keyElement, dataElement, false);
+}
+
+MapResult mapPutTake(Map map, MapKeyElement keyElement, MapDataElement dataElement)
+{
+    if (map == NULL || keyElement == NULL || dataElement == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    MAP_COUNT(map, puts);
+    map->iterator.map = NULL;
+    if (map->int_keys)
+    {
+        return intMapPut(map, *(int *)keyElement, dataElement, true);
+    }
+    return treePut(map, keyElement, dataElement, true);
+}
+
 MapDataElement mapGet(Map map, MapKeyElement keyElement)
 {
     if (map == NULL || keyElement == NULL)
     {
         return NULL;
     }
-    map->current = findKey(map, keyElement);
-    if (map->current == NULL)
+    MAP_COUNT(map, gets);
+    if (map->int_keys)
+    {
+        IntTableSlot *slot = map->table->slots + intMapFind(map, *(int *)keyElement);
+        return slot->order != 0 ? slot->value : NULL;
+    }
+    Leaf leaf;
+    int index;
+    if (!findKey(map, keyElement, &leaf, &index))
     {
         return NULL;
     }
-    return map->current->data;
+    return leaf->data[index];
 }
 
 MapResult mapRemove(Map map, MapKeyElement keyElement)
@@ -240,24 +1698,61 @@ MapResult mapRemove(Map map, MapKeyElement keyElement)
     {
         return MAP_NULL_ARGUMENT;
     }
-    map->current = findKey(map, keyElement);
-    if (map->current == NULL)
+    MAP_COUNT(map, removes);
+    map->iterator.map = NULL;
+    if (map->int_keys)
+    {
+        return intMapRemove(map, *(int *)keyElement);
+    }
+    Leaf leaf;
+    int index;
+    if (!findKey(map, keyElement, &leaf, &index))
     {
         return MAP_ITEM_DOES_NOT_EXIST;
     }
-    Node current = map->current;
-    map->current->previous->next = map->current->next;
-    if (map->current->next != NULL)
+    if (!nodeUnshare(map, &map->root))
+    {
+        return MAP_OUT_OF_MEMORY;
+    }
+    Node node = map->root;
+    MAP_COUNT(map, nodes_visited);
+    while (!node->is_leaf)
     {
-        map->current->next->previous = map->current->previous;
+        Internal internal = (Internal)node;
+        index = internalChildIndex(map, internal, keyElement);
+        if (!nodeUnshare(map, &internal->children[index]))
+        {
+            return MAP_OUT_OF_MEMORY;
+        }
+        if (internal->children[index]->size <= NODE_MIN_KEYS)
+        {
+            if (fixChild(map, internal, &index) != MAP_SUCCESS)
+            {
+                return MAP_OUT_OF_MEMORY;
+            }
+        }
+        node = internal->children[index];
+        MAP_COUNT(map, nodes_visited);
+        if (map->root == (Node)internal && internal->node.size == 0)
+        {
+            map->root = node;
+            nodeFree(map, &internal->node);
+        }
     }
-    map->current = map->current->previous;
-    map->freeData(current->data);
-    map->freeKey(current->key);
-    current->next = NULL;
-    current->previous = NULL;
-    free(current);
+    leaf = (Leaf)node;
+    index = nodeLowerBound(map, node, keyElement);
+    nodeFreeKey(map, node, index);
+    MAP_FREE_DATA(map, leaf->data[index]);
+    nodeMoveKeys(map, node, index, node, index + 1, node->size - index - 1);
+    memmove(leaf->data + index, leaf->data + index + 1,
+            sizeof(MapDataElement) * (node->size - index - 1));
+    node->size--;
     map->counter--;
+    if (map->root->size == 0 && map->root->is_leaf)
+    {
+        nodeFree(map, map->root);
+        map->root = NULL;
+    }
     return MAP_SUCCESS;
 }
 
@@ -267,50 +1762,305 @@ MapKeyElement mapGetFirst(Map map)
     {
         return NULL;
     }
-    map->current = map->first->next; // skip dummy item
-    if (map->current == NULL)
+    map->iterator = mapCursorFirst(map);
+    if (!mapCursorIsValid(&map->iterator))
     {
         return NULL;
     }
-    return map->copyKey(map->current->key);
+    return keyElementCopy(map, mapCursorGetKey(&map->iterator));
 }
 
 MapKeyElement mapGetNext(Map map)
 {
-    if (map == NULL)
+    if (map == NULL || !mapCursorIsValid(&map->iterator))
+    {
+        return NULL;
+    }
+    mapCursorNext(&map->iterator);
+    if (!mapCursorIsValid(&map->iterator))
     {
         return NULL;
     }
-    if (map->current == NULL)
+    return keyElementCopy(map, mapCursorGetKey(&map->iterator));
+}
+
+MapResult mapClear(Map map)
+{
+    if (map == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    map->iterator.map = NULL;
+    if (map->int_keys)
+    {
+        intMapClear(map);
+        return MAP_SUCCESS;
+    }
+    treeRelease(map);
+    map->counter = 0;
+    return MAP_SUCCESS;
+}
+
+/** Pushes node and the leftmost path below it onto the path of the cursor */
+static void cursorDescend(MapCursor *cursor, Node node)
+{
+    while (true)
+    {
+        assert(cursor->depth < MAP_CURSOR_MAX_DEPTH);
+        cursor->path[cursor->depth] = node;
+        cursor->indexes[cursor->depth] = 0;
+        cursor->depth++;
+        if (node->is_leaf)
+        {
+            return;
+        }
+        node = ((Internal)node)->children[0];
+    }
+}
+
+/**
+ * Moves a cursor whose position ran past the end of its node to the next
+ * position holding a key, invalidating it at the end of the map or once it
+ * reaches its end key.
+ */
+static void cursorSettle(MapCursor *cursor)
+{
+    Map map = cursor->map;
+    if (map->int_keys)
+    {
+        if (cursor->indexes[0] >= map->counter)
+        {
+            cursor->map = NULL;
+        }
+    }
+    else if (cursor->indexes[cursor->depth - 1] >= ((Node)cursor->path[cursor->depth - 1])->size)
+    {
+        int level = cursor->depth - 2;
+        while (level >= 0 && ++cursor->indexes[level] > ((Node)cursor->path[level])->size)
+        {
+            level--;
+        }
+        if (level < 0)
+        {
+            cursor->map = NULL;
+            return;
+        }
+        cursor->depth = level + 1;
+        cursorDescend(cursor, ((Internal)cursor->path[level])->children[cursor->indexes[level]]);
+    }
+    if (cursor->map != NULL && cursor->end != NULL &&
+        MAP_COMPARE_KEYS(map, mapCursorGetKey(cursor), cursor->end) >= 0)
+    {
+        cursor->map = NULL;
+    }
+}
+
+MapCursor mapCursorFirst(Map map)
+{
+    MapCursor cursor;
+    cursor.map = NULL;
+    cursor.end = NULL;
+    cursor.depth = 0;
+    cursor.indexes[0] = 0;
+    if (map == NULL || map->counter == 0)
+    {
+        return cursor;
+    }
+    MAP_COUNT(map, iterations);
+    if (map->int_keys)
+    {
+        intTableSortOrder(map->table);
+    }
+    else
+    {
+        cursorDescend(&cursor, map->root);
+    }
+    cursor.map = map;
+    return cursor;
+}
+
+MapCursor mapCursorLowerBound(Map map, MapKeyElement keyElement)
+{
+    MapCursor cursor;
+    cursor.map = NULL;
+    cursor.end = NULL;
+    cursor.depth = 0;
+    cursor.indexes[0] = 0;
+    if (map == NULL || keyElement == NULL || map->counter == 0)
+    {
+        return cursor;
+    }
+    MAP_COUNT(map, iterations);
+    if (map->int_keys)
+    {
+        intTableSortOrder(map->table);
+        cursor.indexes[0] = intTableOrderFind(map->table, *(int *)keyElement);
+    }
+    else
+    {
+        Node node = map->root;
+        while (true)
+        {
+            assert(cursor.depth < MAP_CURSOR_MAX_DEPTH);
+            MAP_COUNT(map, nodes_visited);
+            int index = node->is_leaf ? nodeLowerBound(map, node, keyElement)
+                                      : internalChildIndex(map, (Internal)node, keyElement);
+            cursor.path[cursor.depth] = node;
+            cursor.indexes[cursor.depth] = index;
+            cursor.depth++;
+            if (node->is_leaf)
+            {
+                break;
+            }
+            node = ((Internal)node)->children[index];
+        }
+    }
+    cursor.map = map;
+    cursorSettle(&cursor);
+    return cursor;
+}
+
+MapCursor mapCursorRange(Map map, MapKeyElement lowElement, MapKeyElement highElement)
+{
+    MapCursor cursor = mapCursorLowerBound(map, lowElement);
+    if (highElement == NULL)
+    {
+        cursor.map = NULL;
+        return cursor;
+    }
+    cursor.end = highElement;
+    if (mapCursorIsValid(&cursor) && MAP_COMPARE_KEYS(map, mapCursorGetKey(&cursor), highElement) >= 0)
+    {
+        cursor.map = NULL;
+    }
+    return cursor;
+}
+
+void mapCursorNext(MapCursor *cursor)
+{
+    if (!mapCursorIsValid(cursor))
+    {
+        return;
+    }
+    cursor->indexes[cursor->depth > 0 ? cursor->depth - 1 : 0]++;
+    cursorSettle(cursor);
+}
+
+bool mapCursorIsValid(MapCursor *cursor)
+{
+    return cursor != NULL && cursor->map != NULL;
+}
+
+MapKeyElement mapCursorGetKey(MapCursor *cursor)
+{
+    if (!mapCursorIsValid(cursor))
     {
         return NULL;
     }
-    if (map->current->next == NULL)
+    Map map = cursor->map;
+    if (map->int_keys)
+    {
+        return &map->table->slots[map->table->order[cursor->indexes[0]].slot].key;
+    }
+    return nodeKey(map, cursor->path[cursor->depth - 1], cursor->indexes[cursor->depth - 1]);
+}
+
+MapDataElement mapCursorGetData(MapCursor *cursor)
+{
+    if (!mapCursorIsValid(cursor))
     {
         return NULL;
     }
-    map->current = map->current->next;
-    return map->copyKey(map->current->key);
+    Map map = cursor->map;
+    if (map->int_keys)
+    {
+        return map->table->slots[map->table->order[cursor->indexes[0]].slot].value;
+    }
+    return ((Leaf)cursor->path[cursor->depth - 1])->data[cursor->indexes[cursor->depth - 1]];
 }
 
-MapResult mapClear(Map map)
+MapResult mapGetStatistics(Map map, MapStatistics *statistics)
+{
+    if (map == NULL || statistics == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+#ifdef MAP_STATISTICS
+    *statistics = map->statistics;
+    return MAP_SUCCESS;
+#else
+    return MAP_ERROR;
+#endif
+}
+
+MapResult mapResetStatistics(Map map)
 {
     if (map == NULL)
     {
         return MAP_NULL_ARGUMENT;
     }
-    map->current = map->first->next;
-    while (map->current != NULL)
+#ifdef MAP_STATISTICS
+    memset(&map->statistics, 0, sizeof(map->statistics));
+    return MAP_SUCCESS;
+#else
+    return MAP_ERROR;
+#endif
+}
+
+/** Adds the key copies and data elements below node to usage */
+static void nodeMemoryUsage(Map map, Node node, sizeMapKeyElements keySize,
+                            sizeMapDataElements dataSize, MapMemoryUsage *usage)
+{
+    if (keySize != NULL && map->inline_key_size == 0)
+    {
+        for (int i = 0; i < node->size; i++)
+        {
+            usage->keys += keySize(nodeKey(map, node, i));
+        }
+    }
+    if (node->is_leaf)
     {
-        Node tmp = map->current;
-        map->current = map->current->next;
-        map->freeData(tmp->data);
-        map->freeKey(tmp->key);
-        tmp->next = NULL;
-        tmp->previous = NULL;
-        free(tmp);
+        for (int i = 0; dataSize != NULL && i < node->size; i++)
+        {
+            usage->data += dataSize(((Leaf)node)->data[i]);
+        }
+        return;
+    }
+    for (int i = 0; i <= node->size; i++)
+    {
+        nodeMemoryUsage(map, ((Internal)node)->children[i], keySize, dataSize, usage);
+    }
+}
+
+MapResult mapMemoryUsage(Map map, sizeMapKeyElements keySize, sizeMapDataElements dataSize,
+                         MapMemoryUsage *usage)
+{
+    if (map == NULL || usage == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    usage->structure = sizeof(*map) + sizeof(*map->store);
+    usage->nodes = nodePoolMemoryUsage(&map->store->leaf_pool) +
+                   nodePoolMemoryUsage(&map->store->internal_pool);
+    usage->structure += elementHoldersMemoryUsage(map->store->holders);
+    usage->keys = 0;
+    usage->data = 0;
+    if (map->int_keys)
+    {
+        IntTable table = map->table;
+        usage->structure += intTableMemoryUsage(table);
+        for (int i = 0; dataSize != NULL && i < table->capacity; i++)
+        {
+            if (table->slots[i].order != 0)
+            {
+                usage->data += dataSize(table->slots[i].value);
+            }
+        }
+        return MAP_SUCCESS;
+    }
+    if (map->root != NULL)
+    {
+        nodeMemoryUsage(map, map->root, keySize, dataSize, usage);
     }
-    map->first->next = NULL;
-    map->counter = 0;
     return MAP_SUCCESS;
 }
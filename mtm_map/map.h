@@ -2,6 +2,7 @@
 #define MAP_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
 * Generic Map Container
@@ -13,14 +14,27 @@
 *
 * The following functions are available:
 *   mapCreate		- Creates a new empty map
+*   mapCreateInt	- Creates a new empty map keyed by int, with O(1) expected
+*   				  mapGet, mapContains, mapPut and mapRemove
+*   mapCreateInline - Creates a new empty map whose small fixed size keys are
+*   				  stored inside the map nodes instead of being copied
 *   mapDestroy		- Deletes an existing map and frees all resources
-*   mapCopy		- Copies an existing map
+*   mapCopy		- Copies an existing map in O(n)
+*   mapSnapshot	- Creates an O(1) snapshot of a map, which shares its storage
+*   				  until one of them is changed. Only for maps created by
+*   				  mapCreate or mapCreateInline whose data is never
+*   				  changed in place.
+*   mapBuildSorted	- Fills an empty map from pairs sorted by key in O(n)
 *   mapGetSize		- Returns the size of a given map
 *   mapContains	- returns weather or not a key exists inside the map.
 *   				  This resets the internal iterator.
 *   mapPut		    - Gives a specific key a given value.
 *   				  If the key exists, the value is overridden.
 *   				  This resets the internal iterator.
+*   mapPutTake		- Like mapPut, but the map takes the given value
+*   				  itself instead of a copy of it.
+*   mapPutBatch	- Puts an array of pairs in any order, merging them into
+*   				  the map in O(n log n) overall.
 *   mapGet  	    - Returns the data paired to a key which matches the given key.
 *					  Iterator status unchanged
 *   mapRemove		- Removes a pair of (key,data) elements for which the key
@@ -33,8 +47,28 @@
 *	 mapClear		- Clears the contents of the map. Frees all the elements of
 *	 				  the map using the free function.
 * 	 MAP_FOREACH	- A macro for iterating over the map's elements.
+*   mapCursorFirst	- Returns a cursor to the first (smallest) key in the map.
+*   mapCursorLowerBound - Returns a cursor to the first key not smaller than
+*   				  a given key, in O(log n).
+*   mapCursorRange	- Returns a cursor over the keys in a half open range.
+*   mapCursorNext	- Advances a cursor to the next key.
+*   mapCursorIsValid - returns weather or not a cursor points to an element.
+*   mapCursorGetKey	- Returns the key a cursor points to, without copying it.
+*   mapCursorGetData - Returns the data a cursor points to, without copying it.
+*   MAP_CURSOR_FOREACH - A macro for iterating over the map with a cursor.
+*   MAP_CURSOR_RANGE_FOREACH - A macro for iterating over a range of keys.
+*   mapGetStatistics - Returns the work counters of a map, when built with
+*   				  MAP_STATISTICS defined.
+*   mapResetStatistics - Sets the work counters of a map back to zero.
+*   mapMemoryUsage	- Returns the bytes of memory a map and its elements use.
 */
 
+/** Largest key size, in bytes, accepted by mapCreateInline */
+#define MAP_MAX_INLINE_KEY_SIZE 16
+
+/** Deepest map tree a cursor can walk, well above what INT_MAX pairs need */
+#define MAP_CURSOR_MAX_DEPTH 12
+
 /** Type for defining the map */
 typedef struct Map_t *Map;
 
@@ -76,6 +110,12 @@ typedef void(*freeMapKeyElements)(MapKeyElement);
 */
 typedef int(*compareMapKeyElements)(MapKeyElement, MapKeyElement);
 
+/** Type of function returning the bytes owned by a data element of the map */
+typedef size_t(*sizeMapDataElements)(MapDataElement);
+
+/** Type of function returning the bytes owned by a key element of the map */
+typedef size_t(*sizeMapKeyElements)(MapKeyElement);
+
 /**
 * mapCreate: Allocates a new empty map.
 *
@@ -99,6 +139,54 @@ Map mapCreate(copyMapDataElements copyDataElement,
               freeMapKeyElements freeKeyElement,
               compareMapKeyElements compareKeyElements);
 
+/**
+* mapCreateInt: Allocates a new empty map whose keys are ints.
+* Keys are passed and returned as pointers to int, exactly like a map created
+* by mapCreate with int copy, free and compare functions, but they are stored
+* inline in a hash table instead of being copied one by one.
+* Iteration still returns the keys in ascending order. The order is computed
+* on demand, so the first mapGetFirst after k keys were inserted out of order
+* costs O(n + k log k). Removed keys are dropped from it lazily, so
+* mapRemove stays O(1) expected between iterations.
+* Such a map has no snapshots, see mapSnapshot. Use mapCopy instead.
+*
+* @param copyDataElement - Function pointer to be used for copying data elements into
+*  	the map or when copying the map.
+* @param freeDataElement - Function pointer to be used for removing data elements from
+* 		the map
+* @return
+* 	NULL - if one of the parameters is NULL or allocations failed.
+* 	A new Map in case of success.
+*/
+Map mapCreateInt(copyMapDataElements copyDataElement,
+                 freeMapDataElements freeDataElement);
+
+/**
+* mapCreateInline: Allocates a new empty map whose keys are plain data of a
+* fixed size, such as ints or small structs without pointers.
+* Keys are copied byte by byte into the map's own nodes, so inserting a pair
+* allocates nothing but the data element copy, and the nodes themselves come
+* from slabs owned by the map which mapClear and mapDestroy release at once.
+* Keys returned by mapGetFirst and mapGetNext are copies to be released with
+* free.
+*
+* @param copyDataElement - Function pointer to be used for copying data elements into
+*  	the map or when copying the map.
+* @param freeDataElement - Function pointer to be used for removing data elements from
+* 		the map
+* @param compareKeyElements - Function pointer to be used for comparing key elements
+* 		inside the map.
+* @param key_size - The size in bytes of every key, at most MAP_MAX_INLINE_KEY_SIZE.
+* @return
+* 	NULL - if one of the parameters is NULL, key_size is out of range or
+* 		allocations failed.
+* 	A new Map in case of success.
+*/
+Map mapCreateInline(copyMapDataElements copyDataElement,
+                    freeMapDataElements freeDataElement,
+                    compareMapKeyElements compareKeyElements,
+                    int key_size);
+
 /**
 * mapDestroy: Deallocates an existing map. Clears all elements by using the
 * stored free functions.
@@ -119,6 +207,54 @@ void mapDestroy(Map map);
 */
 Map mapCopy(Map map);
 
+/**
+* mapBuildSorted: Fills an empty map with pairs given in ascending key order.
+* The map is built in a single O(n) pass instead of n separate insertions.
+* Copies of the elements are stored, as in mapPut.
+* Iterator's value is undefined after this operation.
+*
+* @param map - Target map. Must be empty.
+* @param keys - Array of size key elements in strictly ascending order, as
+* 		decided by the comparison function of the map.
+* @param data - Array of size data elements, data[i] is paired with keys[i].
+* @param size - The number of pairs.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent as map, array or element.
+* 	MAP_ERROR if the map is not empty, size is negative or the keys are not
+* 		strictly ascending. The map is left unchanged.
+* 	MAP_OUT_OF_MEMORY if an allocation failed. The map is left empty.
+* 	MAP_SUCCESS if all the pairs were inserted.
+*/
+MapResult mapBuildSorted(Map map, MapKeyElement *keys, MapDataElement *data, int size);
+
+/**
+* mapSnapshot: Creates a snapshot of target map in O(1).
+* The snapshot is a map of its own holding the pairs of map at the time of
+* the call. Both maps share their storage, and a change to either of them
+* copies only what it touches: mapPut and mapRemove copy the nodes on the
+* path to the changed key. The copied nodes share the key and data elements
+* of the nodes they copy, each element is freed by the last map holding it.
+* Data elements are shared between the maps, so they must not be changed in
+* place through one map while a snapshot of it still exists: put a new
+* element with mapPut or mapPutTake instead.
+* Maps created by mapCreateInt keep their pairs in one table which cannot be
+* shared this way, so they have no snapshots, and neither have the tables of
+* map_template.h.
+* A snapshot is therefore no frozen view of the chess system: its maps are
+* made by mapCreateInt or MAP_DEFINE, and players and tournaments are
+* changed in place. Such a view needs a copy of the data, as mapCopy makes.
+* A snapshot can be changed, copied, snapshotted and destroyed like any
+* other map.
+* Iterator's value of the snapshot is undefined.
+*
+* @param map - Target map.
+* @return
+* 	NULL if a NULL was sent, map was created by mapCreateInt or a memory
+* 	allocation failed.
+* 	A Map containing the same elements as map otherwise.
+*/
+Map mapSnapshot(Map map);
+
 /**
 * mapGetSize: Returns the number of elements in a map
 * @param map - The map which size is requested
@@ -160,6 +296,48 @@ bool mapContains(Map map, MapKeyElement element);
 */
 MapResult mapPut(Map map, MapKeyElement keyElement, MapDataElement dataElement);
 
+/**
+*	mapPutTake: Gives a specified key a specific value, taking ownership of the
+*  value instead of copying it.
+*  Iterator's value is undefined after this operation.
+*
+* @param map - The map for which to reassign the data element
+* @param keyElement - The key element which need to be reassigned. A copy of
+*      it is stored, as in mapPut.
+* @param dataElement - The new data element to associate with the given key.
+*      On success the element itself is stored in the map, which will free it
+*      using the free function given at initialization. The old data memory
+*      is deleted using the same function. On failure the element still
+*      belongs to the caller.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent as map or keyElement or dataElement
+* 	MAP_OUT_OF_MEMORY if an allocation failed
+* 	MAP_SUCCESS the paired elements had been inserted successfully
+*/
+MapResult mapPutTake(Map map, MapKeyElement keyElement, MapDataElement dataElement);
+
+/**
+*	mapPutBatch: Gives many keys their values at once, as if mapPut was called
+*  for every pair in the given order: when keys repeat, the last pair wins.
+*  The pairs are sorted and merged with the map in a single pass, so putting
+*  k pairs into a map of n costs O(k log k + n) instead of k separate
+*  insertions. A batch much smaller than the map is put pair by pair in key
+*  order. Copies of the elements are stored, as in mapPut.
+*  Iterator's value is undefined after this operation.
+*
+* @param map - The map to put the pairs into.
+* @param keys - Array of size key elements, in any order.
+* @param data - Array of size data elements, data[i] is paired with keys[i].
+* @param size - The number of pairs.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent as map, array or element.
+* 	MAP_ERROR if size is negative.
+* 	MAP_OUT_OF_MEMORY if an allocation failed. Only part of the pairs may
+* 		have been put.
+* 	MAP_SUCCESS if all the pairs were put.
+*/
+MapResult mapPutBatch(Map map, MapKeyElement *keys, MapDataElement *data, int size);
+
 /**
 *	mapGet: Returns the data associated with a specific key in the map.
 *			Iterator status unchanged
@@ -189,6 +367,9 @@ MapDataElement mapGet(Map map, MapKeyElement keyElement);
 * @return
 * 	MAP_NULL_ARGUMENT if a NULL was sent to the function
 *  MAP_ITEM_DOES_NOT_EXIST if an equal key item does not already exists in the map
+*  MAP_OUT_OF_MEMORY if rebalancing the map required a key copy which failed,
+*  	or copying storage shared with a snapshot failed. The map is left
+*  	unchanged apart from its internal layout.
 * 	MAP_SUCCESS the paired elements had been removed successfully
 */
 MapResult mapRemove(Map map, MapKeyElement keyElement);
@@ -232,6 +413,110 @@ MapKeyElement mapGetNext(Map map);
 */
 MapResult mapClear(Map map);
 
+/**
+* Cursor for iterating over a map without copying its keys.
+* A cursor borrows the key and data elements of the map: they still belong
+* to the map and must not be freed, and the key must not be modified.
+* Cursors are independent of the internal iterator and of each other, so
+* any number of them can be used on the same map at once. All the cursors of
+* a map become invalid once it is changed by mapPut, mapRemove or mapClear;
+* changing the data elements themselves is allowed.
+* The fields are internal to the map and must not be used directly.
+*/
+typedef struct MapCursor_t
+{
+    Map map;
+    MapKeyElement end;
+    int depth;
+    void *path[MAP_CURSOR_MAX_DEPTH];
+    int indexes[MAP_CURSOR_MAX_DEPTH];
+} MapCursor;
+
+/**
+*	mapCursorFirst: Returns a cursor to the smallest key element in the map.
+*	No allocation is done.
+*
+* @param map - The map to iterate over.
+* @return
+* 	An invalid cursor if a NULL pointer was sent or the map is empty.
+* 	A cursor to the first key element of the map otherwise.
+*/
+MapCursor mapCursorFirst(Map map);
+
+/**
+*	mapCursorLowerBound: Returns a cursor to the smallest key element in the map
+*	which is not smaller than the given key, found in O(log n) without going
+*	over the keys before it. The key itself need not be in the map.
+*	No allocation is done.
+*
+* @param map - The map to search in.
+* @param keyElement - The key to start from. Compared using the comparison
+* 		function of the map.
+* @return
+* 	An invalid cursor if a NULL pointer was sent or all the keys of the map
+* 		are smaller than keyElement.
+* 	A cursor to the first key element not smaller than keyElement otherwise.
+*/
+MapCursor mapCursorLowerBound(Map map, MapKeyElement keyElement);
+
+/**
+*	mapCursorRange: Returns a cursor over the key elements k of the map with
+*	lowElement <= k < highElement. The cursor starts as mapCursorLowerBound
+*	does and becomes invalid on reaching highElement, so walking a range of
+*	r keys costs O(log n + r).
+*	The cursor keeps highElement itself, which must stay valid and unchanged
+*	as long as the cursor is used.
+*
+* @param map - The map to iterate over.
+* @param lowElement - The smallest key of the range.
+* @param highElement - The first key past the end of the range.
+* @return
+* 	An invalid cursor if a NULL pointer was sent or the range holds no key.
+* 	A cursor to the first key element of the range otherwise.
+*/
+MapCursor mapCursorRange(Map map, MapKeyElement lowElement, MapKeyElement highElement);
+
+/**
+*	mapCursorNext: Advances a cursor to the next key element. The cursor becomes
+*	invalid once it passes the last key element, or the end of its range.
+*
+* @param cursor - The cursor to advance. Nothing is done for a NULL or
+* 		invalid cursor.
+*/
+void mapCursorNext(MapCursor *cursor);
+
+/**
+*	mapCursorIsValid: Checks if a cursor points to an element of its map.
+*
+* @param cursor - The cursor to check.
+* @return
+* 	false - if NULL was sent or the cursor passed the end of the map.
+* 	true - otherwise.
+*/
+bool mapCursorIsValid(MapCursor *cursor);
+
+/**
+*	mapCursorGetKey: Returns the key element a cursor points to. The element is
+*	not copied and still belongs to the map.
+*
+* @param cursor - The cursor to read.
+* @return
+* 	NULL if NULL was sent or the cursor is invalid.
+* 	The key element the cursor points to otherwise.
+*/
+MapKeyElement mapCursorGetKey(MapCursor *cursor);
+
+/**
+*	mapCursorGetData: Returns the data element a cursor points to. The element
+*	is not copied and still belongs to the map.
+*
+* @param cursor - The cursor to read.
+* @return
+* 	NULL if NULL was sent or the cursor is invalid.
+* 	The data element the cursor points to otherwise.
+*/
+MapDataElement mapCursorGetData(MapCursor *cursor);
+
 /*!
 * Macro for iterating over a map.
 * Declares a new iterator for the loop.
@@ -241,4 +526,104 @@ MapResult mapClear(Map map);
         iterator ;\
         iterator = mapGetNext(map))
 
+/*!
+* Macro for iterating over a map with a cursor.
+* Declares a new cursor for the loop.
+*/
+#define MAP_CURSOR_FOREACH(cursor, map) \
+    for(MapCursor cursor = mapCursorFirst(map) ; \
+        mapCursorIsValid(&cursor) ;\
+        mapCursorNext(&cursor))
+
+/*!
+* Macro for iterating over the keys k of a map with low <= k < high.
+* Declares a new cursor for the loop.
+*/
+#define MAP_CURSOR_RANGE_FOREACH(cursor, map, low, high) \
+    for(MapCursor cursor = mapCursorRange(map, low, high) ; \
+        mapCursorIsValid(&cursor) ;\
+        mapCursorNext(&cursor))
+
+/**
+* Counters of the work done through a map since it was created or its
+* counters were reset. They are only kept when map.c is compiled with
+* MAP_STATISTICS defined, at the cost of an increment per event.
+*/
+typedef struct MapStatistics_t
+{
+    long long puts;             /* mapPut and mapPutTake calls */
+    long long batches;          /* mapPutBatch calls */
+    long long gets;             /* mapGet calls */
+    long long contains;         /* mapContains calls */
+    long long removes;          /* mapRemove calls */
+    long long iterations;       /* Iterations and cursors started, including
+                                   the ones mapCopy and mapPutBatch start */
+    long long key_comparisons;  /* Calls to the compare function */
+    long long nodes_visited;    /* Tree nodes entered by searches and updates */
+    long long probes;           /* Slots inspected in maps made by mapCreateInt */
+    long long key_copies;       /* Calls to the key copy function */
+    long long key_frees;        /* Calls to the key free function */
+    long long data_copies;      /* Calls to the data copy function */
+    long long data_frees;       /* Calls to the data free function */
+} MapStatistics;
+
+/**
+* mapGetStatistics: Reads the work counters of a map.
+* Snapshots and copies start with their own counters at zero.
+*
+* @param map - The map to read.
+* @param statistics - Where to write the counters.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent.
+* 	MAP_ERROR if the map module was compiled without MAP_STATISTICS.
+* 	MAP_SUCCESS otherwise.
+*/
+MapResult mapGetStatistics(Map map, MapStatistics *statistics);
+
+/**
+* mapResetStatistics: Sets all the work counters of a map to zero.
+*
+* @param map - The map whose counters are reset.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent.
+* 	MAP_ERROR if the map module was compiled without MAP_STATISTICS.
+* 	MAP_SUCCESS otherwise.
+*/
+MapResult mapResetStatistics(Map map);
+
+/**
+* Bytes of memory used by a map, as filled in by mapMemoryUsage.
+* Storage a map shares with its snapshots is counted in full for each of
+* them.
+*/
+typedef struct MapMemoryUsage_t
+{
+    size_t structure;   /* The map itself and, for maps made by mapCreateInt,
+                           its table */
+    size_t nodes;       /* Node slabs, used or free, with the keys of maps
+                           made by mapCreateInline stored in them */
+    size_t keys;        /* Key copies of maps made by mapCreate, separator
+                           copies included */
+    size_t data;        /* Data elements */
+} MapMemoryUsage;
+
+/**
+* mapMemoryUsage: Measures the memory used by a map in O(n).
+* The map cannot know the size of its elements, so it asks the given
+* functions for every key and data element it owns.
+* Iterator's value is unchanged.
+*
+* @param map - The map to measure.
+* @param keySize - Returns the bytes owned by a key copy. Only used for maps
+* 		made by mapCreate. If NULL, key copies are not counted.
+* @param dataSize - Returns the bytes owned by a data element. If NULL, data
+* 		elements are not counted.
+* @param usage - Where to write the result.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent as map or usage.
+* 	MAP_SUCCESS otherwise.
+*/
+MapResult mapMemoryUsage(Map map, sizeMapKeyElements keySize, sizeMapDataElements dataSize,
+                         MapMemoryUsage *usage);
+
 #endif /* MAP_H_ */
@@ -0,0 +1,665 @@
+#ifndef MAP_TEMPLATE_H_
+#define MAP_TEMPLATE_H_
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "map.h"
+
+/**
+* Type specialized maps
+*
+* MAP_TABLE_DEFINE generates an open addressing hash table for one key type
+* and one value type, with linear probing and removal by shifting the
+* following entries back instead of leaving tombstones. Key order is only
+* needed for iteration, so an array of (key, slot) pairs is kept on the
+* side, and every slot knows the position of its pair in it. The array is a
+* sorted prefix, extended while keys are put in ascending order, followed by
+* the keys put out of order. Removing a key only marks its pair as removed,
+* in O(1). The next iteration drops the removed pairs, sorts the keys put
+* out of order and merges them into the prefix, in O(n + k log k) for k
+* keys put out of order. The removed pairs are also dropped whenever they
+* fill the array.
+* The table stores values as they are and never copies or frees them.
+*
+* MAP_TABLE_DEFINE(Type, prefix, KeyType, ValueType) defines:
+*   Type				- The table type
+*   TypeCursor		- A cursor over the table, in ascending key order
+*   prefixCreate		- Creates a new empty table
+*   prefixDestroy	- Deletes a table, leaving its values as they are
+*   prefixCopy		- Copies a table slot for slot, values included
+*   prefixGetSize	- Returns the number of pairs in the table
+*   prefixMemoryUsage - Returns the bytes used by the table
+*   prefixProbe		- Returns the slot holding a key, or the empty slot
+*   				  where it would be placed
+*   prefixFind		- Returns a pointer to the value of a key, or NULL.
+*   				  Valid until the table next changes.
+*   prefixContains	- Returns weather or not a key exists in the table
+*   prefixReserve	- Makes room for a number of pairs, so that putting
+*   				  them does not resize the table
+*   prefixInsertAt	- Puts a missing key in the slot prefixProbe returned
+*   				  for it, growing the table if needed
+*   prefixPut		- Pairs a key with a value, replacing an old value
+*   prefixRemoveAt	- Removes the pair held by a slot
+*   prefixRemove		- Removes a key, giving back its value
+*   prefixClear		- Removes all the pairs of the table
+*   prefixSortOrder	- Sorts the array of keys, dropping the removed ones
+*   prefixOrderFind	- Returns the position of a key in the array sorted by
+*   				  prefixSortOrder, or where it would be placed
+*   prefixCursorFirst, prefixCursorNext, prefixCursorIsValid,
+*   prefixCursorGetKey, prefixCursorGetValue
+*   				- Cursor functions, as the ones of map.h
+*
+* MAP_DEFINE generates a map type for one key type and one data type, with
+* the same behaviour as a map created by mapCreateInt, on top of a table
+* generated by MAP_TABLE_DEFINE. Keys and data are passed by value instead of
+* through void pointers, and the hashing, comparison, copy and free logic are
+* direct calls the compiler can inline.
+*
+* MAP_DEFINE(Type, prefix, KeyType, DataType, copyData, freeData) defines the
+* table TypeTable with the prefix prefixTable, and:
+*   Type				- The map type
+*   TypeCursor		- A cursor over the map, as MapCursor
+*   prefixCreate		- Creates a new empty map
+*   prefixDestroy	- Deletes a map and frees all its data elements
+*   prefixCopy		- Copies a map, copying its data elements with copyData
+*   prefixGetSize	- Returns the number of pairs in the map
+*   prefixMemoryUsage - Returns the bytes used by the map, without its data
+*   				  elements
+*   prefixContains	- Returns weather or not a key exists in the map
+*   prefixGet		- Returns the data paired to a key, or NULL
+*   prefixPut		- Pairs a key with a data element which the map takes,
+*   				  as mapPutTake does. An old element is freed.
+*   prefixRemove		- Removes a key and frees its data element
+*   prefixReserve	- Makes room for a number of pairs, so that putting
+*   				  them does not resize the map
+*   prefixClear		- Removes all the pairs of the map
+*   prefixCursorFirst, prefixCursorNext, prefixCursorIsValid,
+*   prefixCursorGetKey, prefixCursorGetData
+*   				- Cursor functions, as the ones of map.h
+*
+* KeyType must be an integer type of at most 64 bits. DataType must be a pointer type, NULL is
+* what prefixGet returns for a missing key. Keys have no such value, so
+* prefixCursorGetKey must only be called on a valid cursor.
+* copyData takes a DataType and returns a copy of it or NULL, freeData frees
+* a DataType.
+* A table holds at most MAP_TEMPLATE_MAX_CAPACITY slots, a change which needs
+* more returns MAP_OUT_OF_MEMORY.
+* All the functions are static inline, so the macros may be used in a header
+* included by several source files.
+*/
+
+#define MAP_TEMPLATE_INITIAL_CAPACITY 16
+#define MAP_TEMPLATE_MAX_CAPACITY (1 << 30)
+#define MAP_TEMPLATE_MAX_LOAD_NUMERATOR 3
+#define MAP_TEMPLATE_MAX_LOAD_DENOMINATOR 4
+#define MAP_TEMPLATE_HASH_MULTIPLIER 0x9E3779B97F4A7C15ull
+#define MAP_TEMPLATE_REMOVED_SLOT -1
+
+#define MAP_TABLE_DEFINE(Type, prefix, KeyType, ValueType) \
+\
+/** order is 1 plus the position of the pair in the order array, 0 for an empty slot */ \
+typedef struct Type##_slot_t \
+{ \
+    KeyType key; \
+    int order; \
+    ValueType value; \
+} Type##Slot; \
+\
+typedef struct Type##_order_t \
+{ \
+    KeyType key; \
+    int slot; \
+} Type##Order; \
+\
+typedef struct Type##_t \
+{ \
+    Type##Slot *slots; \
+    int capacity; \
+    int size; \
+    Type##Order *order; \
+    int order_size; \
+    int order_sorted; \
+} *Type; \
+\
+typedef struct Type##Cursor_t \
+{ \
+    Type table; \
+    int index; \
+} Type##Cursor; \
+\
+/** Takes the home slot from the middle bits of the product, which depend on all 64 key bits */ \
+static inline int prefix##Home(Type table, KeyType key) \
+{ \
+    unsigned long long hash = (unsigned long long)key * MAP_TEMPLATE_HASH_MULTIPLIER; \
+    return (int)((hash >> 32) & (unsigned long long)(table->capacity - 1)); \
+} \
+\
+static inline int prefix##Probe(Type table, KeyType key) \
+{ \
+    int index = prefix##Home(table, key); \
+    while (table->slots[index].order != 0 && table->slots[index].key != key) \
+    { \
+        index = (index + 1) & (table->capacity - 1); \
+    } \
+    return index; \
+} \
+\
+static inline int prefix##OrderFind(Type table, KeyType key) \
+{ \
+    int low = 0, high = table->size; \
+    while (low < high) \
+    { \
+        int middle = low + (high - low) / 2; \
+        if (table->order[middle].key < key) \
+        { \
+            low = middle + 1; \
+        } \
+        else \
+        { \
+            high = middle; \
+        } \
+    } \
+    return low; \
+} \
+\
+static inline Type prefix##Allocate(int capacity) \
+{ \
+    Type table = malloc(sizeof(*table)); \
+    if (table == NULL) \
+    { \
+        return NULL; \
+    } \
+    table->slots = calloc(capacity, sizeof(*table->slots)); \
+    table->order = malloc(sizeof(*table->order) * capacity); \
+    if (table->slots == NULL || table->order == NULL) \
+    { \
+        free(table->slots); \
+        free(table->order); \
+        free(table); \
+        return NULL; \
+    } \
+    table->capacity = capacity; \
+    table->size = 0; \
+    table->order_size = 0; \
+    table->order_sorted = 0; \
+    return table; \
+} \
+\
+static inline Type prefix##Create(void) \
+{ \
+    return prefix##Allocate(MAP_TEMPLATE_INITIAL_CAPACITY); \
+} \
+\
+static inline void prefix##Destroy(Type table) \
+{ \
+    if (table == NULL) \
+    { \
+        return; \
+    } \
+    free(table->slots); \
+    free(table->order); \
+    free(table); \
+} \
+\
+static inline Type prefix##Copy(Type table) \
+{ \
+    if (table == NULL) \
+    { \
+        return NULL; \
+    } \
+    Type copy = prefix##Allocate(table->capacity); \
+    if (copy == NULL) \
+    { \
+        return NULL; \
+    } \
+    memcpy(copy->slots, table->slots, sizeof(*table->slots) * table->capacity); \
+    memcpy(copy->order, table->order, sizeof(*table->order) * table->order_size); \
+    copy->size = table->size; \
+    copy->order_size = table->order_size; \
+    copy->order_sorted = table->order_sorted; \
+    return copy; \
+} \
+\
+static inline int prefix##GetSize(Type table) \
+{ \
+    return table == NULL ? -1 : table->size; \
+} \
+\
+static inline size_t prefix##MemoryUsage(Type table) \
+{ \
+    if (table == NULL) \
+    { \
+        return 0; \
+    } \
+    return sizeof(*table) + (sizeof(*table->slots) + sizeof(*table->order)) * table->capacity; \
+} \
+\
+static inline ValueType *prefix##Find(Type table, KeyType key) \
+{ \
+    if (table == NULL) \
+    { \
+        return NULL; \
+    } \
+    Type##Slot *slot = table->slots + prefix##Probe(table, key); \
+    return slot->order != 0 ? &slot->value : NULL; \
+} \
+\
+static inline bool prefix##Contains(Type table, KeyType key) \
+{ \
+    return table != NULL && table->slots[prefix##Probe(table, key)].order != 0; \
+} \
+\
+static inline MapResult prefix##Resize(Type table, long long capacity) \
+{ \
+    if (capacity > MAP_TEMPLATE_MAX_CAPACITY) \
+    { \
+        return MAP_OUT_OF_MEMORY; \
+    } \
+    Type##Slot *slots = calloc((size_t)capacity, sizeof(*slots)); \
+    if (slots == NULL) \
+    { \
+        return MAP_OUT_OF_MEMORY; \
+    } \
+    Type##Order *order = realloc(table->order, sizeof(*order) * (size_t)capacity); \
+    if (order == NULL) \
+    { \
+        free(slots); \
+        return MAP_OUT_OF_MEMORY; \
+    } \
+    Type##Slot *old_slots = table->slots; \
+    int old_capacity = table->capacity; \
+    table->order = order; \
+    table->slots = slots; \
+    table->capacity = (int)capacity; \
+    for (int i = 0; i < old_capacity; i++) \
+    { \
+        if (old_slots[i].order != 0) \
+        { \
+            int slot = prefix##Probe(table, old_slots[i].key); \
+            table->slots[slot] = old_slots[i]; \
+            table->order[old_slots[i].order - 1].slot = slot; \
+        } \
+    } \
+    free(old_slots); \
+    return MAP_SUCCESS; \
+} \
+\
+/** The load bound is checked in long long, so a size near INT_MAX cannot overflow it */ \
+static inline MapResult prefix##Reserve(Type table, int size) \
+{ \
+    if (table == NULL) \
+    { \
+        return MAP_NULL_ARGUMENT; \
+    } \
+    long long limit = (long long)MAP_TEMPLATE_MAX_CAPACITY / MAP_TEMPLATE_MAX_LOAD_DENOMINATOR * \
+                      MAP_TEMPLATE_MAX_LOAD_NUMERATOR; \
+    if (size > limit) \
+    { \
+        return MAP_OUT_OF_MEMORY; \
+    } \
+    long long capacity = table->capacity; \
+    while ((long long)size * MAP_TEMPLATE_MAX_LOAD_DENOMINATOR > capacity * MAP_TEMPLATE_MAX_LOAD_NUMERATOR) \
+    { \
+        capacity *= 2; \
+    } \
+    if (capacity == table->capacity) \
+    { \
+        return MAP_SUCCESS; \
+    } \
+    return prefix##Resize(table, capacity); \
+} \
+\
+/** Drops the removed pairs from the order array, keeping the others in place */ \
+static inline void prefix##OrderCompact(Type table) \
+{ \
+    int kept = 0, sorted = 0; \
+    for (int i = 0; i < table->order_size; i++) \
+    { \
+        if (table->order[i].slot == MAP_TEMPLATE_REMOVED_SLOT) \
+        { \
+            continue; \
+        } \
+        sorted += i < table->order_sorted; \
+        table->order[kept] = table->order[i]; \
+        table->slots[table->order[kept].slot].order = kept + 1; \
+        kept++; \
+    } \
+    table->order_size = kept; \
+    table->order_sorted = sorted; \
+} \
+\
+static inline MapResult prefix##InsertAt(Type table, int slot, KeyType key, ValueType value) \
+{ \
+    if ((long long)(table->size + 1) * MAP_TEMPLATE_MAX_LOAD_DENOMINATOR > \
+        (long long)table->capacity * MAP_TEMPLATE_MAX_LOAD_NUMERATOR) \
+    { \
+        if (prefix##Resize(table, (long long)table->capacity * 2) != MAP_SUCCESS) \
+        { \
+            return MAP_OUT_OF_MEMORY; \
+        } \
+        slot = prefix##Probe(table, key); \
+    } \
+    if (table->order_size == table->capacity) \
+    { \
+        prefix##OrderCompact(table); \
+    } \
+    int position = table->order_size++; \
+    if (table->order_sorted == position && (position == 0 || table->order[position - 1].key < key)) \
+    { \
+        table->order_sorted++; \
+    } \
+    table->order[position].key = key; \
+    table->order[position].slot = slot; \
+    table->slots[slot].key = key; \
+    table->slots[slot].value = value; \
+    table->slots[slot].order = position + 1; \
+    table->size++; \
+    return MAP_SUCCESS; \
+} \
+\
+static inline MapResult prefix##Put(Type table, KeyType key, ValueType value) \
+{ \
+    if (table == NULL) \
+    { \
+        return MAP_NULL_ARGUMENT; \
+    } \
+    int slot = prefix##Probe(table, key); \
+    if (table->slots[slot].order != 0) \
+    { \
+        table->slots[slot].value = value; \
+        return MAP_SUCCESS; \
+    } \
+    return prefix##InsertAt(table, slot, key, value); \
+} \
+\
+static inline void prefix##RemoveAt(Type table, int hole) \
+{ \
+    int mask = table->capacity - 1; \
+    table->order[table->slots[hole].order - 1].slot = MAP_TEMPLATE_REMOVED_SLOT; \
+    table->size--; \
+    for (int next = (hole + 1) & mask; table->slots[next].order != 0; next = (next + 1) & mask) \
+    { \
+        int home = prefix##Home(table, table->slots[next].key); \
+        if (((next - home) & mask) >= ((next - hole) & mask)) \
+        { \
+            table->slots[hole] = table->slots[next]; \
+            table->order[table->slots[hole].order - 1].slot = hole; \
+            hole = next; \
+        } \
+    } \
+    table->slots[hole].order = 0; \
+} \
+\
+static inline MapResult prefix##Remove(Type table, KeyType key, ValueType *removed) \
+{ \
+    if (table == NULL) \
+    { \
+        return MAP_NULL_ARGUMENT; \
+    } \
+    int slot = prefix##Probe(table, key); \
+    if (table->slots[slot].order == 0) \
+    { \
+        return MAP_ITEM_DOES_NOT_EXIST; \
+    } \
+    if (removed != NULL) \
+    { \
+        *removed = table->slots[slot].value; \
+    } \
+    prefix##RemoveAt(table, slot); \
+    return MAP_SUCCESS; \
+} \
+\
+static inline void prefix##Clear(Type table) \
+{ \
+    if (table == NULL) \
+    { \
+        return; \
+    } \
+    for (int i = 0; i < table->capacity; i++) \
+    { \
+        table->slots[i].order = 0; \
+    } \
+    table->size = 0; \
+    table->order_size = 0; \
+    table->order_sorted = 0; \
+} \
+\
+static inline int prefix##CompareOrder(const void *entry_1, const void *entry_2) \
+{ \
+    KeyType first = ((const Type##Order *)entry_1)->key; \
+    KeyType second = ((const Type##Order *)entry_2)->key; \
+    return (first > second) - (first < second); \
+} \
+\
+/** Merges the sorted keys past the sorted prefix into it, from the back, with a copy of them */ \
+static inline bool prefix##OrderMerge(Type table) \
+{ \
+    int sorted = table->order_sorted; \
+    int pending = table->size - sorted; \
+    Type##Order *merged = malloc(sizeof(*merged) * pending); \
+    if (merged == NULL) \
+    { \
+        return false; \
+    } \
+    memcpy(merged, table->order + sorted, sizeof(*merged) * pending); \
+    int i = sorted - 1, j = pending - 1; \
+    for (int k = table->size - 1; j >= 0; k--) \
+    { \
+        table->order[k] = i >= 0 && table->order[i].key > merged[j].key ? table->order[i--] : merged[j--]; \
+    } \
+    free(merged); \
+    return true; \
+} \
+\
+static inline void prefix##SortOrder(Type table) \
+{ \
+    if (table->order_size == table->size && table->order_sorted == table->size) \
+    { \
+        return; \
+    } \
+    prefix##OrderCompact(table); \
+    int pending = table->size - table->order_sorted; \
+    qsort(table->order + table->order_sorted, pending, sizeof(*table->order), prefix##CompareOrder); \
+    if (table->order_sorted > 0 && !prefix##OrderMerge(table)) \
+    { \
+        qsort(table->order, table->size, sizeof(*table->order), prefix##CompareOrder); \
+    } \
+    table->order_sorted = table->size; \
+    for (int i = 0; i < table->size; i++) \
+    { \
+        table->slots[table->order[i].slot].order = i + 1; \
+    } \
+} \
+\
+static inline Type##Cursor prefix##CursorFirst(Type table) \
+{ \
+    Type##Cursor cursor = {NULL, 0}; \
+    if (table == NULL || table->size == 0) \
+    { \
+        return cursor; \
+    } \
+    prefix##SortOrder(table); \
+    cursor.table = table; \
+    return cursor; \
+} \
+\
+static inline bool prefix##CursorIsValid(Type##Cursor *cursor) \
+{ \
+    return cursor != NULL && cursor->table != NULL; \
+} \
+\
+static inline void prefix##CursorNext(Type##Cursor *cursor) \
+{ \
+    if (prefix##CursorIsValid(cursor) && ++cursor->index >= cursor->table->size) \
+    { \
+        cursor->table = NULL; \
+    } \
+} \
+\
+static inline KeyType prefix##CursorGetKey(Type##Cursor *cursor) \
+{ \
+    return cursor->table->order[cursor->index].key; \
+} \
+\
+static inline ValueType prefix##CursorGetValue(Type##Cursor *cursor) \
+{ \
+    return cursor->table->slots[cursor->table->order[cursor->index].slot].value; \
+}
+
+#define MAP_DEFINE(Type, prefix, KeyType, DataType, copyData, freeData) \
+\
+MAP_TABLE_DEFINE(Type##Table, prefix##Table, KeyType, DataType) \
+\
+typedef Type##Table Type; \
+typedef Type##TableCursor Type##Cursor; \
+\
+static inline Type prefix##Create(void) \
+{ \
+    return prefix##TableCreate(); \
+} \
+\
+static inline void prefix##Clear(Type map) \
+{ \
+    if (map == NULL) \
+    { \
+        return; \
+    } \
+    for (int i = 0; i < map->capacity; i++) \
+    { \
+        if (map->slots[i].order != 0) \
+        { \
+            freeData(map->slots[i].value); \
+        } \
+    } \
+    prefix##TableClear(map); \
+} \
+\
+static inline void prefix##Destroy(Type map) \
+{ \
+    prefix##Clear(map); \
+    prefix##TableDestroy(map); \
+} \
+\
+static inline Type prefix##Copy(Type map) \
+{ \
+    Type copy = prefix##TableCopy(map); \
+    if (copy == NULL) \
+    { \
+        return NULL; \
+    } \
+    for (int i = 0; i < copy->capacity; i++) \
+    { \
+        if (copy->slots[i].order != 0) \
+        { \
+            copy->slots[i].value = copyData(map->slots[i].value); \
+            if (copy->slots[i].value == NULL) \
+            { \
+                for (int j = i; j < copy->capacity; j++) \
+                { \
+                    copy->slots[j].order = 0; \
+                } \
+                prefix##Destroy(copy); \
+                return NULL; \
+            } \
+        } \
+    } \
+    return copy; \
+} \
+\
+static inline int prefix##GetSize(Type map) \
+{ \
+    return prefix##TableGetSize(map); \
+} \
+\
+static inline size_t prefix##MemoryUsage(Type map) \
+{ \
+    return prefix##TableMemoryUsage(map); \
+} \
+\
+static inline bool prefix##Contains(Type map, KeyType key) \
+{ \
+    return prefix##TableContains(map, key); \
+} \
+\
+static inline DataType prefix##Get(Type map, KeyType key) \
+{ \
+    DataType *data = prefix##TableFind(map, key); \
+    return data == NULL ? NULL : *data; \
+} \
+\
+static inline MapResult prefix##Reserve(Type map, int size) \
+{ \
+    return prefix##TableReserve(map, size); \
+} \
+\
+static inline MapResult prefix##Put(Type map, KeyType key, DataType data) \
+{ \
+    if (map == NULL || data == NULL) \
+    { \
+        return MAP_NULL_ARGUMENT; \
+    } \
+    int slot = prefix##TableProbe(map, key); \
+    if (map->slots[slot].order != 0) \
+    { \
+        if (map->slots[slot].value != data) \
+        { \
+            freeData(map->slots[slot].value); \
+            map->slots[slot].value = data; \
+        } \
+        return MAP_SUCCESS; \
+    } \
+    return prefix##TableInsertAt(map, slot, key, data); \
+} \
+\
+static inline MapResult prefix##Remove(Type map, KeyType key) \
+{ \
+    DataType data; \
+    MapResult result = prefix##TableRemove(map, key, &data); \
+    if (result == MAP_SUCCESS) \
+    { \
+        freeData(data); \
+    } \
+    return result; \
+} \
+\
+static inline Type##Cursor prefix##CursorFirst(Type map) \
+{ \
+    return prefix##TableCursorFirst(map); \
+} \
+\
+static inline bool prefix##CursorIsValid(Type##Cursor *cursor) \
+{ \
+    return prefix##TableCursorIsValid(cursor); \
+} \
+\
+static inline void prefix##CursorNext(Type##Cursor *cursor) \
+{ \
+    prefix##TableCursorNext(cursor); \
+} \
+\
+static inline KeyType prefix##CursorGetKey(Type##Cursor *cursor) \
+{ \
+    return prefix##TableCursorGetKey(cursor); \
+} \
+\
+static inline DataType prefix##CursorGetData(Type##Cursor *cursor) \
+{ \
+    if (!prefix##CursorIsValid(cursor)) \
+    { \
+        return NULL; \
+    } \
+    return prefix##TableCursorGetValue(cursor); \
+}
+
+/*!
+* Macro for iterating over a map generated by MAP_DEFINE, or a table generated
+* by MAP_TABLE_DEFINE, with a cursor.
+* Declares a new cursor for the loop.
+*/
+#define MAP_DEFINE_FOREACH(Type, prefix, cursor, map) \
+    for(Type##Cursor cursor = prefix##CursorFirst(map) ; \
+        prefix##CursorIsValid(&cursor) ;\
+        prefix##CursorNext(&cursor))
+
+#endif /* MAP_TEMPLATE_H_ */
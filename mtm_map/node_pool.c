@@ -0,0 +1,96 @@
+#include "node_pool.h"
+#include <stdlib.h>
+
+#define FIRST_SLAB_OBJECTS 2
+
+typedef union node_pool_align_t
+{
+    void *pointer;
+    long long integer;
+    long double floating;
+} NodePoolAlign;
+
+struct node_pool_slab_t
+{
+    struct node_pool_slab_t *next;
+    int object_count;
+    NodePoolAlign objects[];
+};
+
+void nodePoolInit(NodePool *pool, size_t object_size)
+{
+    size_t alignment = sizeof(NodePoolAlign);
+    if (object_size < sizeof(void *))
+    {
+        object_size = sizeof(void *);
+    }
+    pool->object_size = (object_size + alignment - 1) / alignment * alignment;
+    pool->slabs = NULL;
+    pool->slab_objects = 0;
+    pool->slab_used = 0;
+    pool->free_list = NULL;
+}
+
+void *nodePoolAlloc(NodePool *pool)
+{
+    if (pool->free_list != NULL)
+    {
+        void *object = pool->free_list;
+        pool->free_list = *(void **)object;
+        return object;
+    }
+    if (pool->slabs == NULL || pool->slab_used == pool->slab_objects)
+    {
+        int objects = pool->slab_objects == 0 ? FIRST_SLAB_OBJECTS : pool->slab_objects * 2;
+        if (objects > NODE_POOL_MAX_SLAB_OBJECTS)
+        {
+            objects = NODE_POOL_MAX_SLAB_OBJECTS;
+        }
+        struct node_pool_slab_t *slab = malloc(sizeof(*slab) + pool->object_size * objects);
+        if (slab == NULL)
+        {
+            return NULL;
+        }
+        slab->next = pool->slabs;
+        slab->object_count = objects;
+        pool->slabs = slab;
+        pool->slab_objects = objects;
+        pool->slab_used = 0;
+    }
+    void *object = (char *)pool->slabs->objects + pool->object_size * pool->slab_used;
+    pool->slab_used++;
+    return object;
+}
+
+void nodePoolFree(NodePool *pool, void *object)
+{
+    if (object == NULL)
+    {
+        return;
+    }
+    *(void **)object = pool->free_list;
+    pool->free_list = object;
+}
+
+void nodePoolClear(NodePool *pool)
+{
+    while (pool->slabs != NULL)
+    {
+        struct node_pool_slab_t *next = pool->slabs->next;
+        free(pool->slabs);
+        pool->slabs = next;
+    }
+    pool->slab_objects = 0;
+    pool->slab_used = 0;
+    pool->free_list = NULL;
+}
+
+size_t nodePoolMemoryUsage(const NodePool *pool)
+{
+    size_t bytes = 0;
+    for (struct node_pool_slab_t *slab = pool->slabs; slab != NULL; slab = slab->next)
+    {
+        bytes += sizeof(*slab) + pool->object_size * slab->object_count;
+    }
+    return bytes;
+}
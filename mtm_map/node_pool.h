@@ -0,0 +1,75 @@
+#ifndef NODE_POOL_H_
+#define NODE_POOL_H_
+
+#include <stddef.h>
+
+/**
+* Node Pool
+*
+* Allocates objects of one fixed size out of large blocks (slabs) owned by
+* the pool. Freed objects are kept on a free list for reuse, and all the
+* slabs are released together by nodePoolClear, so a container built on a
+* pool makes one malloc call per slab instead of one per node.
+* Slabs start small and double in size up to NODE_POOL_MAX_SLAB_OBJECTS, so
+* small containers do not pay for a large slab.
+*
+* The following functions are available:
+*   nodePoolInit	- Initializes an empty pool for objects of a given size
+*   nodePoolAlloc	- Returns an uninitialized object from the pool
+*   nodePoolFree	- Returns an object to the pool for reuse
+*   nodePoolClear	- Releases every slab of the pool at once
+*   nodePoolMemoryUsage - Returns the bytes held by the slabs of the pool
+*/
+
+#define NODE_POOL_MAX_SLAB_OBJECTS 64
+
+/** The pool state. Meant to be embedded in its owner, fields are internal */
+typedef struct NodePool_t
+{
+    size_t object_size;
+    struct node_pool_slab_t *slabs;
+    int slab_objects;
+    int slab_used;
+    void *free_list;
+} NodePool;
+
+/**
+* nodePoolInit: Initializes an empty pool. No memory is allocated.
+* @param pool - The pool to initialize.
+* @param object_size - The size in bytes of every object of the pool.
+*/
+void nodePoolInit(NodePool *pool, size_t object_size);
+
+/**
+* nodePoolAlloc: Returns an object from the pool. The object is suitably
+* aligned for any type and its content is undefined.
+* @param pool - The pool to allocate from.
+* @return
+* 	NULL if allocating a new slab failed.
+* 	A new object otherwise.
+*/
+void *nodePoolAlloc(NodePool *pool);
+
+/**
+* nodePoolFree: Returns an object to the pool for reuse. The memory itself
+* is only released by nodePoolClear.
+* @param pool - The pool the object was allocated from.
+* @param object - The object to return. If NULL nothing is done.
+*/
+void nodePoolFree(NodePool *pool, void *object);
+
+/**
+* nodePoolClear: Releases all the slabs of the pool. Every object allocated
+* from the pool becomes invalid, and the pool can be used again.
+* @param pool - The pool to clear.
+*/
+void nodePoolClear(NodePool *pool);
+
+/**
+* nodePoolMemoryUsage: Returns the bytes allocated for the slabs of the
+* pool, counting the objects in use and the free ones alike.
+* @param pool - The pool to measure.
+*/
+size_t nodePoolMemoryUsage(const NodePool *pool);
+
+#endif /* NODE_POOL_H_ */
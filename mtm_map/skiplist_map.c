@@ -0,0 +1,820 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "skiplist_map.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define NULL_MAP_SIZE -1
+#define LIMBO_LISTS 3
+#define ADVANCE_INTERVAL 64
+#define LEVEL_SHIFT 2
+
+/** Both the inserting and the removing thread must be done with a node to retire it */
+#define NODE_OWNERS 2
+
+#define LOAD(pointer) __atomic_load_n(pointer, __ATOMIC_ACQUIRE)
+#define STORE(pointer, value) __atomic_store_n(pointer, value, __ATOMIC_RELEASE)
+#define CAS(pointer, expected, desired) \
+    casPointer((void **)(pointer), (void *)(expected), (void *)(desired))
+
+typedef enum RetiredKind_t
+{
+    RETIRED_NODE,
+    RETIRED_VALUE
+} RetiredKind;
+
+/** Header of the objects waiting in a limbo list until no thread can read them */
+typedef struct Retired_t
+{
+    struct Retired_t *next;
+    RetiredKind kind;
+} *Retired;
+
+/** A data element, boxed so that replacing and removing it is one pointer swap */
+typedef struct SkipValue_t
+{
+    struct Retired_t retired;
+    MapDataElement data;
+} *SkipValue;
+
+/**
+* A skip list node. The lowest bit of a next pointer marks the node as
+* being unlinked at that level. A node is in the map while its value is not
+* NULL, so removing a key is the swap of its value to NULL.
+*/
+typedef struct SkipNode_t
+{
+    struct Retired_t retired;
+    MapKeyElement key;
+    SkipValue value;
+    int owners;
+    int height;
+    struct SkipNode_t *next[];
+} *SkipNode;
+
+/**
+* Per thread reclamation state of one map. state is the announced epoch
+* shifted left, plus 1 while active. A record is held by its map and by the
+* thread owning it, whose records are chained through thread_next under
+* the process-wide thread key; detached is set once the map is destroyed.
+*/
+typedef struct ThreadRecord_t
+{
+    struct ThreadRecord_t *next;
+    struct ThreadRecord_t *thread_next;
+    struct SkipListMap_t *map;
+    int owned;
+    int detached;
+    int references;
+    unsigned long state;
+    int nesting;
+    int operations;
+    unsigned int random;
+    Retired limbo[LIMBO_LISTS];
+    unsigned long limbo_epoch[LIMBO_LISTS];
+} *ThreadRecord;
+
+struct SkipListMap_t
+{
+    SkipNode head;
+    int size;
+    unsigned long epoch;
+    ThreadRecord records;
+    copyMapDataElements copyData;
+    copyMapKeyElements copyKey;
+    freeMapDataElements freeData;
+    freeMapKeyElements freeKey;
+    compareMapKeyElements compareKey;
+};
+
+static bool casPointer(void **pointer, void *expected, void *desired);
+static bool isMarked(SkipNode node);
+static SkipNode markedNode(SkipNode node);
+static SkipNode unmarkedNode(SkipNode node);
+static SkipNode nodeCreate(int height);
+static int randomHeight(ThreadRecord record);
+static void retiredFree(SkipListMap map, Retired retired);
+static void retiredFreeList(SkipListMap map, Retired list);
+static void threadKeyCreate(void);
+static bool threadKeyInit(void);
+static void threadRecordRelease(ThreadRecord record);
+static void threadRecordsRelease(void *records);
+static ThreadRecord threadRecordAcquire(SkipListMap map);
+static ThreadRecord skipListEnter(SkipListMap map);
+static void skipListExit(ThreadRecord record);
+static void skipListTryAdvance(SkipListMap map, ThreadRecord caller);
+static void skipListRetire(SkipListMap map, ThreadRecord record, Retired retired);
+static void nodeReleaseOwner(SkipListMap map, ThreadRecord record, SkipNode node);
+static void nodeMark(SkipNode node);
+static bool skipListFind(SkipListMap map, MapKeyElement key, SkipNode *preds, SkipNode *succs);
+static void skipListLinkLevels(SkipListMap map, SkipNode node, SkipNode *preds, SkipNode *succs);
+static SkipNode skipListLowerBound(SkipListMap map, MapKeyElement key);
+static MapResult skipListVisit(SkipListMap map, MapKeyElement low, MapKeyElement high,
+                               visitMapElements visit, void *context);
+
+/** One thread-specific data key for every map, holding the records of the calling thread */
+static pthread_key_t thread_key;
+static pthread_once_t thread_key_once = PTHREAD_ONCE_INIT;
+static bool thread_key_created = false;
+
+static bool casPointer(void **pointer, void *expected, void *desired)
+{
+    return __atomic_compare_exchange_n(pointer, &expected, desired, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static bool isMarked(SkipNode node)
+{
+    return ((uintptr_t)node & 1) != 0;
+}
+
+static SkipNode markedNode(SkipNode node)
+{
+    return (SkipNode)((uintptr_t)node | 1);
+}
+
+static SkipNode unmarkedNode(SkipNode node)
+{
+    return (SkipNode)((uintptr_t)node & ~(uintptr_t)1);
+}
+
+static SkipNode nodeCreate(int height)
+{
+    SkipNode node = malloc(sizeof(*node) + sizeof(SkipNode) * height);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+    node->retired.kind = RETIRED_NODE;
+    node->key = NULL;
+    node->value = NULL;
+    node->owners = NODE_OWNERS;
+    node->height = height;
+    for (int i = 0; i < height; i++)
+    {
+        node->next[i] = NULL;
+    }
+    return node;
+}
+
+/** Draws a height where each level is 1 << LEVEL_SHIFT times rarer than the one below */
+static int randomHeight(ThreadRecord record)
+{
+    unsigned int random = record->random;
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    record->random = random;
+    int height = 1;
+    while (height < SKIP_LIST_MAX_HEIGHT && (random & ((1u << LEVEL_SHIFT) - 1)) == 0)
+    {
+        height++;
+        random >>= LEVEL_SHIFT;
+    }
+    return height;
+}
+
+static void retiredFree(SkipListMap map, Retired retired)
+{
+    if (retired->kind == RETIRED_VALUE)
+    {
+        SkipValue value = (SkipValue)retired;
+        map->freeData(value->data);
+        free(value);
+        return;
+    }
+    SkipNode node = (SkipNode)retired;
+    map->freeKey(node->key);
+    free(node);
+}
+
+static void retiredFreeList(SkipListMap map, Retired list)
+{
+    while (list != NULL)
+    {
+        Retired next = list->next;
+        retiredFree(map, list);
+        list = next;
+    }
+}
+
+static void threadKeyCreate(void)
+{
+    thread_key_created = pthread_key_create(&thread_key, threadRecordsRelease) == 0;
+}
+
+static bool threadKeyInit(void)
+{
+    return pthread_once(&thread_key_once, threadKeyCreate) == 0 && thread_key_created;
+}
+
+/** Drops one holder of a record, freeing it after both its map and its thread let go */
+static void threadRecordRelease(ThreadRecord record)
+{
+    if (__atomic_sub_fetch(&record->references, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        free(record);
+    }
+}
+
+/** Thread exit handler of the thread key: frees the records of the thread for reuse */
+static void threadRecordsRelease(void *records)
+{
+    ThreadRecord record = records;
+    while (record != NULL)
+    {
+        ThreadRecord next = record->thread_next;
+        if (!LOAD(&record->detached))
+        {
+            __atomic_store_n(&record->state, 0, __ATOMIC_SEQ_CST);
+            STORE(&record->owned, false);
+        }
+        threadRecordRelease(record);
+        record = next;
+    }
+}
+
+/**
+* Returns the record of the calling thread, claiming or adding one on its
+* first call. Records of destroyed maps met on the way are dropped.
+*/
+static ThreadRecord threadRecordAcquire(SkipListMap map)
+{
+    if (!threadKeyInit())
+    {
+        return NULL;
+    }
+    ThreadRecord first = pthread_getspecific(thread_key);
+    ThreadRecord head = first;
+    ThreadRecord *link = &head;
+    ThreadRecord record;
+    while ((record = *link) != NULL)
+    {
+        if (LOAD(&record->detached))
+        {
+            *link = record->thread_next;
+            threadRecordRelease(record);
+            continue;
+        }
+        if (record->map == map)
+        {
+            break;
+        }
+        link = &record->thread_next;
+    }
+    if (record == NULL)
+    {
+        for (record = LOAD(&map->records); record != NULL; record = record->next)
+        {
+            int unowned = false;
+            if (!LOAD(&record->owned) &&
+                __atomic_compare_exchange_n(&record->owned, &unowned, true, false,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                __atomic_add_fetch(&record->references, 1, __ATOMIC_RELAXED);
+                break;
+            }
+        }
+    }
+    else if (head == first)
+    {
+        return record;
+    }
+    if (record == NULL)
+    {
+        record = malloc(sizeof(*record));
+        if (record == NULL)
+        {
+            return NULL;
+        }
+        record->map = map;
+        record->owned = true;
+        record->detached = false;
+        record->references = 2;
+        record->state = 0;
+        record->nesting = 0;
+        record->operations = 0;
+        record->random = (unsigned int)(uintptr_t)record | 1;
+        for (int i = 0; i < LIMBO_LISTS; i++)
+        {
+            record->limbo[i] = NULL;
+            record->limbo_epoch[i] = 0;
+        }
+        do
+        {
+            record->next = LOAD(&map->records);
+        } while (!CAS(&map->records, record->next, record));
+    }
+    if (*link == NULL)
+    {
+        record->thread_next = head;
+        head = record;
+    }
+    /* Only the first value set for the key in a thread needs memory, so on
+       failure the thread had no records and the new one is the only one */
+    if (pthread_setspecific(thread_key, head) != 0)
+    {
+        STORE(&record->owned, false);
+        threadRecordRelease(record);
+        return NULL;
+    }
+    return record;
+}
+
+/** Starts an operation: nodes the thread reaches stay allocated until skipListExit */
+static ThreadRecord skipListEnter(SkipListMap map)
+{
+    ThreadRecord record = threadRecordAcquire(map);
+    if (record == NULL)
+    {
+        return NULL;
+    }
+    if (record->nesting++ == 0)
+    {
+        unsigned long epoch = __atomic_load_n(&map->epoch, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&record->state, (epoch << 1) | 1, __ATOMIC_SEQ_CST);
+    }
+    return record;
+}
+
+/** Ends an operation, and every ADVANCE_INTERVAL operations tries to move the epoch */
+static void skipListExit(ThreadRecord record)
+{
+    if (--record->nesting == 0)
+    {
+        __atomic_store_n(&record->state, 0, __ATOMIC_RELEASE);
+        if (++record->operations % ADVANCE_INTERVAL == 0)
+        {
+            skipListTryAdvance(record->map, record);
+        }
+    }
+}
+
+/**
+* Moves the global epoch forward if every active thread has seen the current
+* one, then frees the limbo lists of the caller filled LIMBO_LISTS - 1 or more
+* epochs ago: every thread active in their epoch has announced a later one
+* since, so none can still read their objects.
+*/
+static void skipListTryAdvance(SkipListMap map, ThreadRecord caller)
+{
+    unsigned long epoch = __atomic_load_n(&map->epoch, __ATOMIC_SEQ_CST);
+    bool advance = true;
+    for (ThreadRecord record = LOAD(&map->records); record != NULL; record = record->next)
+    {
+        unsigned long state = __atomic_load_n(&record->state, __ATOMIC_SEQ_CST);
+        if ((state & 1) && (state >> 1) != epoch)
+        {
+            advance = false;
+            break;
+        }
+    }
+    if (advance)
+    {
+        __atomic_compare_exchange_n(&map->epoch, &epoch, epoch + 1, false,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+        epoch = __atomic_load_n(&map->epoch, __ATOMIC_SEQ_CST);
+    }
+    for (int i = 0; i < LIMBO_LISTS; i++)
+    {
+        if (caller->limbo[i] != NULL && epoch - caller->limbo_epoch[i] >= LIMBO_LISTS - 1)
+        {
+            retiredFreeList(map, caller->limbo[i]);
+            caller->limbo[i] = NULL;
+        }
+    }
+}
+
+/**
+* Queues an object no longer reachable from the list in the limbo list of
+* the current epoch. skipListTryAdvance frees the list once it expires; a
+* list still kept when the epoch comes round to its slot again is freed here.
+*/
+static void skipListRetire(SkipListMap map, ThreadRecord record, Retired retired)
+{
+    unsigned long epoch = __atomic_load_n(&map->epoch, __ATOMIC_ACQUIRE);
+    int index = (int)(epoch % LIMBO_LISTS);
+    if (record->limbo_epoch[index] != epoch)
+    {
+        retiredFreeList(map, record->limbo[index]);
+        record->limbo[index] = NULL;
+        record->limbo_epoch[index] = epoch;
+    }
+    retired->next = record->limbo[index];
+    record->limbo[index] = retired;
+}
+
+static void nodeReleaseOwner(SkipListMap map, ThreadRecord record, SkipNode node)
+{
+    if (__atomic_sub_fetch(&node->owners, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        skipListRetire(map, record, &node->retired);
+    }
+}
+
+/** Marks every level of a node whose value was removed, top level first */
+static void nodeMark(SkipNode node)
+{
+    for (int level = node->height - 1; level >= 0; level--)
+    {
+        SkipNode next = LOAD(&node->next[level]);
+        while (!isMarked(next) && !CAS(&node->next[level], next, markedNode(next)))
+        {
+            next = LOAD(&node->next[level]);
+        }
+    }
+}
+
+/**
+* Fills preds and succs with the last node before key and the first node not
+* before it at every level, unlinking the marked nodes on the way.
+* Returns whether succs[0] holds key.
+*/
+static bool skipListFind(SkipListMap map, MapKeyElement key, SkipNode *preds, SkipNode *succs)
+{
+retry:
+    {
+        SkipNode pred = map->head;
+        for (int level = SKIP_LIST_MAX_HEIGHT - 1; level >= 0; level--)
+        {
+            SkipNode current = LOAD(&pred->next[level]);
+            if (isMarked(current))
+            {
+                goto retry;
+            }
+            while (current != NULL)
+            {
+                SkipNode next = LOAD(&current->next[level]);
+                if (isMarked(next))
+                {
+                    if (!CAS(&pred->next[level], current, unmarkedNode(next)))
+                    {
+                        goto retry;
+                    }
+                    current = unmarkedNode(next);
+                    continue;
+                }
+                if (map->compareKey(current->key, key) >= 0)
+                {
+                    break;
+                }
+                pred = current;
+                current = next;
+            }
+            preds[level] = pred;
+            succs[level] = current;
+        }
+    }
+    return succs[0] != NULL && map->compareKey(succs[0]->key, key) == 0;
+}
+
+/** Links the levels above the lowest of a node just inserted, until done or the node is removed */
+static void skipListLinkLevels(SkipListMap map, SkipNode node, SkipNode *preds, SkipNode *succs)
+{
+    for (int level = 1; level < node->height; level++)
+    {
+        while (true)
+        {
+            SkipNode next = LOAD(&node->next[level]);
+            if (isMarked(next))
+            {
+                return;
+            }
+            if (next != succs[level] && !CAS(&node->next[level], next, succs[level]))
+            {
+                continue;
+            }
+            if (CAS(&preds[level]->next[level], succs[level], node))
+            {
+                break;
+            }
+            skipListFind(map, node->key, preds, succs);
+            if (isMarked(LOAD(&node->next[0])))
+            {
+                return;
+            }
+        }
+    }
+}
+
+/**
+* Returns the first unmarked node whose key is not smaller than key, without
+* unlinking. Marked nodes are stepped over but never descended from, as their
+* lower levels may already miss nodes inserted after they were removed.
+*/
+static SkipNode skipListLowerBound(SkipListMap map, MapKeyElement key)
+{
+    SkipNode pred = map->head;
+    SkipNode current = NULL;
+    for (int level = SKIP_LIST_MAX_HEIGHT - 1; level >= 0; level--)
+    {
+        current = unmarkedNode(LOAD(&pred->next[level]));
+        while (current != NULL)
+        {
+            SkipNode next = LOAD(&current->next[level]);
+            if (isMarked(next))
+            {
+                current = unmarkedNode(next);
+                continue;
+            }
+            if (map->compareKey(current->key, key) >= 0)
+            {
+                break;
+            }
+            pred = current;
+            current = next;
+        }
+    }
+    return current;
+}
+
+/** Visits the live nodes from low, or from the first node if low is NULL, up to high */
+static MapResult skipListVisit(SkipListMap map, MapKeyElement low, MapKeyElement high,
+                               visitMapElements visit, void *context)
+{
+    ThreadRecord record = skipListEnter(map);
+    if (record == NULL)
+    {
+        return MAP_OUT_OF_MEMORY;
+    }
+    SkipNode node = low == NULL ? unmarkedNode(LOAD(&map->head->next[0])) : skipListLowerBound(map, low);
+    for (; node != NULL; node = unmarkedNode(LOAD(&node->next[0])))
+    {
+        if (high != NULL && map->compareKey(node->key, high) >= 0)
+        {
+            break;
+        }
+        SkipValue value = LOAD(&node->value);
+        if (value != NULL && !visit(node->key, value->data, context))
+        {
+            break;
+        }
+    }
+    skipListExit(record);
+    return MAP_SUCCESS;
+}
+
+SkipListMap skipListMapCreate(copyMapDataElements copyDataElement,
+                              copyMapKeyElements copyKeyElement,
+                              freeMapDataElements freeDataElement,
+                              freeMapKeyElements freeKeyElement,
+                              compareMapKeyElements compareKeyElements)
+{
+    if (copyDataElement == NULL || copyKeyElement == NULL || freeDataElement == NULL ||
+        freeKeyElement == NULL || compareKeyElements == NULL)
+    {
+        return NULL;
+    }
+    SkipListMap map = malloc(sizeof(*map));
+    if (map == NULL)
+    {
+        return NULL;
+    }
+    map->head = nodeCreate(SKIP_LIST_MAX_HEIGHT);
+    if (map->head == NULL)
+    {
+        free(map);
+        return NULL;
+    }
+    if (!threadKeyInit())
+    {
+        free(map->head);
+        free(map);
+        return NULL;
+    }
+    map->size = 0;
+    map->epoch = 0;
+    map->records = NULL;
+    map->copyData = copyDataElement;
+    map->copyKey = copyKeyElement;
+    map->freeData = freeDataElement;
+    map->freeKey = freeKeyElement;
+    map->compareKey = compareKeyElements;
+    return map;
+}
+
+void skipListMapDestroy(SkipListMap map)
+{
+    if (map == NULL)
+    {
+        return;
+    }
+    SkipNode node = unmarkedNode(map->head->next[0]);
+    while (node != NULL)
+    {
+        SkipNode next = unmarkedNode(node->next[0]);
+        if (node->value != NULL)
+        {
+            retiredFree(map, &node->value->retired);
+        }
+        retiredFree(map, &node->retired);
+        node = next;
+    }
+    ThreadRecord record = map->records;
+    while (record != NULL)
+    {
+        ThreadRecord next = record->next;
+        for (int i = 0; i < LIMBO_LISTS; i++)
+        {
+            retiredFreeList(map, record->limbo[i]);
+        }
+        STORE(&record->detached, true);
+        threadRecordRelease(record);
+        record = next;
+    }
+    free(map->head);
+    free(map);
+}
+
+int skipListMapGetSize(SkipListMap map)
+{
+    if (map == NULL)
+    {
+        return NULL_MAP_SIZE;
+    }
+    return LOAD(&map->size);
+}
+
+bool skipListMapContains(SkipListMap map, MapKeyElement element)
+{
+    if (map == NULL || element == NULL)
+    {
+        return false;
+    }
+    ThreadRecord record = skipListEnter(map);
+    if (record == NULL)
+    {
+        return false;
+    }
+    SkipNode node = skipListLowerBound(map, element);
+    bool found = node != NULL && map->compareKey(node->key, element) == 0 && LOAD(&node->value) != NULL;
+    skipListExit(record);
+    return found;
+}
+
+MapResult skipListMapPut(SkipListMap map, MapKeyElement keyElement, MapDataElement dataElement)
+{
+    if (map == NULL || keyElement == NULL || dataElement == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    ThreadRecord record = skipListEnter(map);
+    if (record == NULL)
+    {
+        return MAP_OUT_OF_MEMORY;
+    }
+    SkipValue value = malloc(sizeof(*value));
+    if (value == NULL)
+    {
+        skipListExit(record);
+        return MAP_OUT_OF_MEMORY;
+    }
+    value->retired.kind = RETIRED_VALUE;
+    value->data = map->copyData(dataElement);
+    if (value->data == NULL)
+    {
+        free(value);
+        skipListExit(record);
+        return MAP_OUT_OF_MEMORY;
+    }
+    SkipNode preds[SKIP_LIST_MAX_HEIGHT];
+    SkipNode succs[SKIP_LIST_MAX_HEIGHT];
+    SkipNode node = NULL;
+    while (true)
+    {
+        if (skipListFind(map, keyElement, preds, succs))
+        {
+            SkipValue old_value = LOAD(&succs[0]->value);
+            if (old_value == NULL)
+            {
+                nodeMark(succs[0]);
+                continue;
+            }
+            if (!CAS(&succs[0]->value, old_value, value))
+            {
+                continue;
+            }
+            skipListRetire(map, record, &old_value->retired);
+            if (node != NULL)
+            {
+                map->freeKey(node->key);
+                free(node);
+            }
+            skipListExit(record);
+            return MAP_SUCCESS;
+        }
+        if (node == NULL)
+        {
+            node = nodeCreate(randomHeight(record));
+            if (node != NULL && (node->key = map->copyKey(keyElement)) == NULL)
+            {
+                free(node);
+                node = NULL;
+            }
+            if (node == NULL)
+            {
+                retiredFree(map, &value->retired);
+                skipListExit(record);
+                return MAP_OUT_OF_MEMORY;
+            }
+            node->value = value;
+        }
+        for (int level = 0; level < node->height; level++)
+        {
+            node->next[level] = succs[level];
+        }
+        if (CAS(&preds[0]->next[0], succs[0], node))
+        {
+            break;
+        }
+    }
+    __atomic_add_fetch(&map->size, 1, __ATOMIC_RELAXED);
+    skipListLinkLevels(map, node, preds, succs);
+    if (isMarked(LOAD(&node->next[0])))
+    {
+        skipListFind(map, node->key, preds, succs);
+    }
+    nodeReleaseOwner(map, record, node);
+    skipListExit(record);
+    return MAP_SUCCESS;
+}
+
+MapDataElement skipListMapGet(SkipListMap map, MapKeyElement keyElement)
+{
+    if (map == NULL || keyElement == NULL)
+    {
+        return NULL;
+    }
+    ThreadRecord record = skipListEnter(map);
+    if (record == NULL)
+    {
+        return NULL;
+    }
+    SkipNode node = skipListLowerBound(map, keyElement);
+    MapDataElement copy = NULL;
+    if (node != NULL && map->compareKey(node->key, keyElement) == 0)
+    {
+        SkipValue value = LOAD(&node->value);
+        copy = value == NULL ? NULL : map->copyData(value->data);
+    }
+    skipListExit(record);
+    return copy;
+}
+
+MapResult skipListMapRemove(SkipListMap map, MapKeyElement keyElement)
+{
+    if (map == NULL || keyElement == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    ThreadRecord record = skipListEnter(map);
+    if (record == NULL)
+    {
+        return MAP_OUT_OF_MEMORY;
+    }
+    SkipNode preds[SKIP_LIST_MAX_HEIGHT];
+    SkipNode succs[SKIP_LIST_MAX_HEIGHT];
+    while (skipListFind(map, keyElement, preds, succs))
+    {
+        SkipNode node = succs[0];
+        SkipValue value = LOAD(&node->value);
+        if (value == NULL)
+        {
+            nodeMark(node);
+            continue;
+        }
+        if (!CAS(&node->value, value, NULL))
+        {
+            continue;
+        }
+        __atomic_sub_fetch(&map->size, 1, __ATOMIC_RELAXED);
+        skipListRetire(map, record, &value->retired);
+        nodeMark(node);
+        skipListFind(map, keyElement, preds, succs);
+        nodeReleaseOwner(map, record, node);
+        skipListExit(record);
+        return MAP_SUCCESS;
+    }
+    skipListExit(record);
+    return MAP_ITEM_DOES_NOT_EXIST;
+}
+
+MapResult skipListMapForEach(SkipListMap map, visitMapElements visit, void *context)
+{
+    if (map == NULL || visit == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    return skipListVisit(map, NULL, NULL, visit, context);
+}
+
+MapResult skipListMapForEachRange(SkipListMap map, MapKeyElement low, MapKeyElement high,
+                                  visitMapElements visit, void *context)
+{
+    if (map == NULL || low == NULL || high == NULL || visit == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    return skipListVisit(map, low, high, visit, context);
+}
@@ -0,0 +1,182 @@
+#ifndef SKIPLIST_MAP_H_
+#define SKIPLIST_MAP_H_
+
+#include <stdbool.h>
+#include "map.h"
+#include "concurrent_map.h"
+
+/**
+* Lock-Free Ordered Map
+*
+* An ordered map which several threads may read and change at the same
+* time without taking locks. Pairs are kept in a lock-free skip list, so
+* lookups, insertions and removals of different keys never wait on each
+* other, and scans visit the keys in ascending order while other threads
+* keep changing the map.
+* Removed nodes and replaced data elements are not freed at once: they are
+* kept until every thread which might still be reading them has finished
+* its current operation (epoch based reclamation).
+*
+* Every operation is atomic on its own. Scans are weakly consistent: they
+* visit each key at most once and in ascending order, they visit every key
+* which is in the map for the whole scan and no key which is out of it for
+* the whole scan, and may or may not visit keys put or removed while they
+* run.
+*
+* A thread using the map is registered with it on its first call. The
+* registration is released when the thread exits, and reused by the next
+* thread to register. All maps share one POSIX thread-specific data key.
+*
+* The following functions are available:
+*   skipListMapCreate	- Creates a new empty map
+*   skipListMapDestroy	- Deletes an existing map and frees all resources
+*   skipListMapGetSize	- Returns the number of pairs in the map
+*   skipListMapContains	- Returns weather or not a key exists inside the map
+*   skipListMapPut		- Gives a specific key a copy of a given value
+*   skipListMapGet		- Returns a copy of the data paired to a key
+*   skipListMapRemove	- Removes the pair of a given key
+*   skipListMapForEach	- Calls a function on every pair in key order
+*   skipListMapForEachRange - Calls a function on the pairs of a key range
+*/
+
+/** Most levels a node of the skip list can have */
+#define SKIP_LIST_MAX_HEIGHT 16
+
+/** Type for defining the lock-free map */
+typedef struct SkipListMap_t *SkipListMap;
+
+/**
+* skipListMapCreate: Allocates a new empty lock-free map.
+*
+* @param copyDataElement - Function pointer to be used for copying data elements into
+*  	the map and out of it.
+* @param copyKeyElement - Function pointer to be used for copying key elements into
+*  	the map.
+* @param freeDataElement - Function pointer to be used for removing data elements from
+* 		the map
+* @param freeKeyElement - Function pointer to be used for removing key elements from
+* 		the map
+* @param compareKeyElements - Function pointer to be used for comparing key elements
+* 		inside the map.
+* @return
+* 	NULL - if one of the parameters is NULL or allocations failed.
+* 	A new SkipListMap in case of success.
+*/
+SkipListMap skipListMapCreate(copyMapDataElements copyDataElement,
+                              copyMapKeyElements copyKeyElement,
+                              freeMapDataElements freeDataElement,
+                              freeMapKeyElements freeKeyElement,
+                              compareMapKeyElements compareKeyElements);
+
+/**
+* skipListMapDestroy: Deallocates an existing map and all of its elements.
+* No other thread may use the map during or after this call.
+*
+* @param map - Target map to be deallocated. If map is NULL nothing will be
+* 		done
+*/
+void skipListMapDestroy(SkipListMap map);
+
+/**
+* skipListMapGetSize: Returns the number of pairs in the map. While other
+* threads change the map the result may lag behind their changes.
+*
+* @param map - The map which size is requested
+* @return
+* 	-1 if a NULL pointer was sent.
+* 	Otherwise the number of elements in the map.
+*/
+int skipListMapGetSize(SkipListMap map);
+
+/**
+* skipListMapContains: Checks if a key element exists in the map.
+*
+* @param map - The map to search in
+* @param element - The element to look for.
+* @return
+* 	false - if one or more of the inputs is null, the key element was not
+* 		found or registering the thread failed.
+* 	true - if the key element was found in the map.
+*/
+bool skipListMapContains(SkipListMap map, MapKeyElement element);
+
+/**
+* skipListMapPut: Gives a specified key a specified value, as mapPut does.
+* Copies of the key and the data are stored.
+*
+* @param map - The map for which to reassign the data element
+* @param keyElement - The key element which need to be reassigned
+* @param dataElement - The new data element to associate with the given key.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent as map or key or data.
+* 	MAP_OUT_OF_MEMORY if an allocation failed. The map is unchanged.
+* 	MAP_SUCCESS the paired elements had been inserted successfully
+*/
+MapResult skipListMapPut(SkipListMap map, MapKeyElement keyElement, MapDataElement dataElement);
+
+/**
+* skipListMapGet: Returns a copy of the data associated with a specific key.
+* The copy is owned by the caller, who must release it with the data free
+* function of the map.
+*
+* @param map - The map for which to get the data element from.
+* @param keyElement - The key element which need to be found and whose data
+*		we want to get.
+* @return
+*  NULL if a NULL pointer was sent, the key was not found or an allocation
+*  	failed.
+*  A copy of the data element associated with the key otherwise.
+*/
+MapDataElement skipListMapGet(SkipListMap map, MapKeyElement keyElement);
+
+/**
+* skipListMapRemove: Removes a pair of key and data elements from the map,
+* as mapRemove does.
+*
+* @param map - The map to remove the elements from.
+* @param keyElement - The key element to find and remove from the map.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent to the function.
+* 	MAP_OUT_OF_MEMORY if registering the thread failed.
+* 	MAP_ITEM_DOES_NOT_EXIST if an equal key item does not already exists in the map
+* 	MAP_SUCCESS the paired elements had been removed successfully
+*/
+MapResult skipListMapRemove(SkipListMap map, MapKeyElement keyElement);
+
+/**
+* skipListMapForEach: Calls a function on every pair of the map, in
+* ascending key order.
+* The key and data given to the function stay valid until it returns. The
+* function may look the map up but must not change it.
+*
+* @param map - The map to iterate over.
+* @param visit - The function to call on every pair. Returning false from it
+* 		stops the iteration.
+* @param context - Passed to visit as is.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent as map or function.
+* 	MAP_OUT_OF_MEMORY if registering the thread failed.
+* 	MAP_SUCCESS otherwise, whether or not visit stopped the iteration.
+*/
+MapResult skipListMapForEach(SkipListMap map, visitMapElements visit, void *context);
+
+/**
+* skipListMapForEachRange: Calls a function on every pair whose key k
+* satisfies low <= k < high, in ascending key order, as skipListMapForEach
+* does.
+*
+* @param map - The map to iterate over.
+* @param low - The smallest key to visit.
+* @param high - The key to stop before.
+* @param visit - The function to call on every pair. Returning false from it
+* 		stops the iteration.
+* @param context - Passed to visit as is.
+* @return
+* 	MAP_NULL_ARGUMENT if a NULL was sent as map, key or function.
+* 	MAP_OUT_OF_MEMORY if registering the thread failed.
+* 	MAP_SUCCESS otherwise, whether or not visit stopped the iteration.
+*/
+MapResult skipListMapForEachRange(SkipListMap map, MapKeyElement low, MapKeyElement high,
+                                  visitMapElements visit, void *context);
+
+#endif /* SKIPLIST_MAP_H_ */
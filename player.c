@@ -3,6 +3,11 @@
 #include "player.h"
 
 #define NULL_PLAYER -1
+#define ADD 1
+#define REDUCE -1
+#define PLAYER_SNAPSHOT_FIELDS 6
+
+static void playerTotalsAddStats(PlayerTotals totals, Player player, int sign);
 
 struct player_t
 {
@@ -14,6 +19,15 @@ struct player_t
     bool removed;
 };
 
+struct player_totals_t
+{
+    int wins;
+    int draws;
+    int loses;
+    int games_played;
+    int time_played;
+};
+
 Player playerCreate()
 {
     Player player = malloc(sizeof(*player));
@@ -203,4 +217,134 @@ bool playerIfWasRemoved(Player player)
         return player->removed;
     }
     return true;
-}
\ No newline at end of file
+}
+
+PlayerTotals playerTotalsCreate()
+{
+    PlayerTotals totals = malloc(sizeof(*totals));
+    if (!totals)
+    {
+        return NULL;
+    }
+    totals->wins = 0;
+    totals->draws = 0;
+    totals->loses = 0;
+    totals->games_played = 0;
+    totals->time_played = 0;
+    return totals;
+}
+
+void playerTotalsDestroy(PlayerTotals totals)
+{
+    free(totals);
+}
+
+PlayerTotals copyPlayerTotals(PlayerTotals totals)
+{
+    if (!totals)
+    {
+        return NULL;
+    }
+    PlayerTotals new_totals = playerTotalsCreate();
+    if (!new_totals)
+    {
+        return NULL;
+    }
+    *new_totals = *totals;
+    return new_totals;
+}
+
+/** Adds the stats of a player to totals, or takes them off with sign REDUCE */
+void playerTotalsAddStats(PlayerTotals totals, Player player, int sign)
+{
+    if (totals == NULL || player == NULL)
+    {
+        return;
+    }
+    totals->wins += sign * player->wins;
+    totals->draws += sign * player->draws;
+    totals->loses += sign * player->loses;
+    totals->games_played += sign * player->games_played;
+    totals->time_played += sign * player->time_played;
+}
+
+void playerTotalsAdd(PlayerTotals totals, Player player)
+{
+    playerTotalsAddStats(totals, player, ADD);
+}
+
+void playerTotalsRemove(PlayerTotals totals, Player player)
+{
+    playerTotalsAddStats(totals, player, REDUCE);
+}
+
+int playerTotalsGetGames(PlayerTotals totals)
+{
+    if (!totals)
+    {
+        return NULL_PLAYER;
+    }
+    return totals->games_played;
+}
+
+int playerTotalsGetLevel(PlayerTotals totals)
+{
+    if (!totals)
+    {
+        return NULL_PLAYER;
+    }
+    return ((6 * totals->wins) - (10 * totals->loses) + (2 * totals->draws));
+}
+
+size_t playerTotalsMemoryUsage(PlayerTotals totals)
+{
+    if (totals == NULL)
+    {
+        return 0;
+    }
+    return sizeof(*totals);
+}
+
+bool playerSaveSnapshot(Player player, FILE *file)
+{
+    int fields[PLAYER_SNAPSHOT_FIELDS] = {player->wins, player->draws, player->loses,
+                                          player->games_played, player->time_played, player->removed};
+    return snapshotWriteInts(file, fields, PLAYER_SNAPSHOT_FIELDS);
+}
+
+bool playerLoadSnapshot(Player player, SnapshotReader *reader)
+{
+    int fields[PLAYER_SNAPSHOT_FIELDS];
+    if (!snapshotReadInts(reader, fields, PLAYER_SNAPSHOT_FIELDS))
+    {
+        return false;
+    }
+    for (int i = 0; i < PLAYER_SNAPSHOT_FIELDS - 1; i++)
+    {
+        if (fields[i] < 0)
+        {
+            return false;
+        }
+    }
+    /* every game played is a win, a draw or a loss, also after an opponent was removed */
+    if ((long long)fields[0] + fields[1] + fields[2] != fields[3])
+    {
+        return false;
+    }
+    player->wins = fields[0];
+    player->draws = fields[1];
+    player->loses = fields[2];
+    player->games_played = fields[3];
+    player->time_played = fields[4];
+    player->removed = fields[5] != 0;
+    return true;
+}
+
+size_t playerMemoryUsage(Player player)
+{
+    if (player == NULL)
+    {
+        return 0;
+    }
+    return sizeof(*player);
+}
@@ -1,8 +1,15 @@
 #ifndef PLAYER_H_
 #define PLAYER_H_
 
+#include <stdbool.h>
+#include "./mtm_map/map_template.h"
+#include "snapshot.h"
+
 typedef struct player_t *Player;
 
+/** The stats of a player summed over all its tournaments */
+typedef struct player_totals_t *PlayerTotals;
+
 /**
 * playerCreate: Allocates a new player.
 * @return 
@@ -141,4 +148,100 @@ void playerReset(Player player);
  * */
 bool playerIfWasRemoved(Player player);
 
-#endif   
\ No newline at end of file
+/**
+* playerTotalsCreate: Allocates new totals, with all the stats at zero.
+* @return
+* NULL if the allocation failed, the new totals otherwise.
+*/
+PlayerTotals playerTotalsCreate();
+
+/**
+* playerTotalsDestroy: Frees totals from memory.
+* @param totals - totals to free.
+*/
+void playerTotalsDestroy(PlayerTotals totals);
+
+/**
+* copyPlayerTotals: returns a copy of the totals.
+* @param totals - totals to copy.
+* @return
+* totals copy if success, NULL if failed.
+*/
+PlayerTotals copyPlayerTotals(PlayerTotals totals);
+
+/**
+* playerTotalsAdd: adds the stats of a player in one tournament to its totals.
+* Does nothing if one of the arguments is NULL.
+* @param totals - totals to update.
+* @param player - the player in the tournament.
+*/
+void playerTotalsAdd(PlayerTotals totals, Player player);
+
+/**
+* playerTotalsRemove: takes the stats of a player in one tournament off its
+* totals, as added by playerTotalsAdd. Taking them off before the stats change
+* and adding them back after updates the totals by the change alone.
+* Does nothing if one of the arguments is NULL.
+* @param totals - totals to update.
+* @param player - the player in the tournament.
+*/
+void playerTotalsRemove(PlayerTotals totals, Player player);
+
+/**
+* playerTotalsGetGames: getter for the games played in all the tournaments.
+* @param totals - totals to get info from.
+* @return
+* -1 if totals is NULL, the games played otherwise.
+*/
+int playerTotalsGetGames(PlayerTotals totals);
+
+/**
+* playerTotalsGetLevel: get the level over all the tournaments, as playerGetLevel.
+* @param totals - totals to get info from.
+* @return
+* -1 if totals is NULL, (6 * WINS) - (10 * LOSES) + (2 * DRAWS) otherwise.
+*/
+int playerTotalsGetLevel(PlayerTotals totals);
+
+/**
+* playerTotalsMemoryUsage: returns the bytes of memory used by totals.
+* @param totals - totals to measure.
+* @return
+* 0 if totals is NULL, the size of the totals otherwise.
+*/
+size_t playerTotalsMemoryUsage(PlayerTotals totals);
+
+/**
+* playerSaveSnapshot: writes the stats of a player to a snapshot file.
+* @param player - player to save.
+* @param file - the snapshot file.
+* @return
+* false if the write failed, true otherwise.
+*/
+bool playerSaveSnapshot(Player player, FILE *file);
+
+/**
+* playerLoadSnapshot: reads the stats of a player from a snapshot, as
+* written by playerSaveSnapshot.
+* @param player - a new player to fill.
+* @param reader - the snapshot to read from.
+* @return
+* false if the snapshot is cut or corrupt, true otherwise.
+*/
+bool playerLoadSnapshot(Player player, SnapshotReader *reader);
+
+/**
+* playerMemoryUsage: returns the bytes of memory used by a player.
+* @param player - player to measure.
+* @return
+* 0 if player is NULL, the size of the player otherwise.
+*/
+size_t playerMemoryUsage(Player player);
+
+/** Map from player ids to the players it owns */
+MAP_DEFINE(PlayerMap, playerMap, int, Player, copyPlayer, playerDestroy)
+
+/** Map from player ids to the totals it owns */
+MAP_DEFINE(PlayerTotalsMap, playerTotalsMap, int, PlayerTotals, copyPlayerTotals, playerTotalsDestroy)
+
+#endif
@@ -0,0 +1,139 @@
+#include <stdlib.h>
+#include <string.h>
+#include "quantile_sketch.h"
+
+#define SUB_BUCKET_BITS 5
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+#define LARGEST_SHIFT (31 - 1 - SUB_BUCKET_BITS)
+#define SKETCH_BUCKETS (SUB_BUCKETS + (LARGEST_SHIFT + 1) * SUB_BUCKETS)
+
+struct quantile_sketch_t
+{
+    int count;
+    int buckets[SKETCH_BUCKETS];
+};
+
+static int quantileSketchBucket(int value);
+static int quantileSketchBucketValue(int bucket);
+
+QuantileSketch quantileSketchCreate()
+{
+    QuantileSketch sketch = malloc(sizeof(*sketch));
+    if (sketch == NULL)
+    {
+        return NULL;
+    }
+    memset(sketch, 0, sizeof(*sketch));
+    return sketch;
+}
+
+void quantileSketchDestroy(QuantileSketch sketch)
+{
+    free(sketch);
+}
+
+QuantileSketch quantileSketchCopy(QuantileSketch sketch)
+{
+    if (sketch == NULL)
+    {
+        return NULL;
+    }
+    QuantileSketch new_sketch = malloc(sizeof(*new_sketch));
+    if (new_sketch == NULL)
+    {
+        return NULL;
+    }
+    memcpy(new_sketch, sketch, sizeof(*new_sketch));
+    return new_sketch;
+}
+
+/** Values below SUB_BUCKETS have their own bucket, larger ones share it with the values of the same top bits */
+int quantileSketchBucket(int value)
+{
+    if (value < SUB_BUCKETS)
+    {
+        return value < 0 ? 0 : value;
+    }
+    int shift = 0;
+    while ((value >> shift) >= 2 * SUB_BUCKETS)
+    {
+        shift++;
+    }
+    return SUB_BUCKETS + shift * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+}
+
+/** Returns the middle of the values of a bucket */
+int quantileSketchBucketValue(int bucket)
+{
+    if (bucket < SUB_BUCKETS)
+    {
+        return bucket;
+    }
+    int shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+    long long top_bits = SUB_BUCKETS + (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+    long long low = top_bits << shift;
+    long long high = ((top_bits + 1) << shift) - 1;
+    return (int)(low + (high - low) / 2);
+}
+
+void quantileSketchAdd(QuantileSketch sketch, int value)
+{
+    if (sketch == NULL)
+    {
+        return;
+    }
+    sketch->buckets[quantileSketchBucket(value)]++;
+    sketch->count++;
+}
+
+void quantileSketchMerge(QuantileSketch sketch, QuantileSketch other)
+{
+    if (sketch == NULL || other == NULL)
+    {
+        return;
+    }
+    for (int i = 0; i < SKETCH_BUCKETS; i++)
+    {
+        sketch->buckets[i] += other->buckets[i];
+    }
+    sketch->count += other->count;
+}
+
+int quantileSketchGetCount(QuantileSketch sketch)
+{
+    return sketch == NULL ? -1 : sketch->count;
+}
+
+int quantileSketchGetQuantile(QuantileSketch sketch, double quantile)
+{
+    if (sketch == NULL || sketch->count == 0)
+    {
+        return 0;
+    }
+    double exact_rank = quantile * sketch->count;
+    int rank = (int)exact_rank;
+    if (rank < exact_rank)
+    {
+        rank++;
+    }
+    rank = rank < 1 ? 1 : (rank > sketch->count ? sketch->count : rank);
+    int seen = 0;
+    for (int i = 0; i < SKETCH_BUCKETS; i++)
+    {
+        seen += sketch->buckets[i];
+        if (seen >= rank)
+        {
+            return quantileSketchBucketValue(i);
+        }
+    }
+    return 0;
+}
+
+size_t quantileSketchMemoryUsage(QuantileSketch sketch)
+{
+    if (sketch == NULL)
+    {
+        return 0;
+    }
+    return sizeof(*sketch);
+}
@@ -0,0 +1,90 @@
+#ifndef QUANTILE_SKETCH_H_
+#define QUANTILE_SKETCH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+* Quantile sketch of positive integers, such as game play times.
+* Values are counted in buckets which grow with the value: values below 32
+* have a bucket each, and every power of two above is split into 32 buckets.
+* A quantile is therefore reported within about 1.6% of the exact value,
+* the sketch has a fixed size whatever the number of values, and two
+* sketches merge by adding their counts.
+*
+* Functions:
+* quantileSketchCreate: Allocates a new empty sketch.
+* quantileSketchDestroy: Frees sketch from memory.
+* quantileSketchCopy: returns a copy of a sketch.
+* quantileSketchAdd: counts a value.
+* quantileSketchMerge: counts the values of another sketch.
+* quantileSketchGetCount: returns the number of values counted.
+* quantileSketchGetQuantile: returns a quantile of the values counted.
+* quantileSketchMemoryUsage: returns the bytes of memory used by a sketch.
+*/
+
+typedef struct quantile_sketch_t *QuantileSketch;
+
+/**
+* quantileSketchCreate: Allocates a new empty sketch.
+* @return
+* NULL if the allocation failed, a new sketch otherwise.
+*/
+QuantileSketch quantileSketchCreate();
+
+/**
+* quantileSketchDestroy: Frees sketch from memory.
+* @param sketch - sketch to free.
+*/
+void quantileSketchDestroy(QuantileSketch sketch);
+
+/**
+* quantileSketchCopy: returns a copy of a sketch.
+* @param sketch - sketch to copy.
+* @return
+* NULL if sketch is NULL or the allocation failed, the copy otherwise.
+*/
+QuantileSketch quantileSketchCopy(QuantileSketch sketch);
+
+/**
+* quantileSketchAdd: counts a value.
+* @param sketch - sketch to update.
+* @param value - the value, must be positive.
+*/
+void quantileSketchAdd(QuantileSketch sketch, int value);
+
+/**
+* quantileSketchMerge: counts the values of another sketch as well.
+* @param sketch - sketch to update.
+* @param other - sketch whose values are added, not changed.
+*/
+void quantileSketchMerge(QuantileSketch sketch, QuantileSketch other);
+
+/**
+* quantileSketchGetCount: returns the number of values counted.
+* @param sketch - sketch to read.
+* @return
+* -1 if sketch is NULL, the number of values otherwise.
+*/
+int quantileSketchGetCount(QuantileSketch sketch);
+
+/**
+* quantileSketchGetQuantile: returns a quantile of the values counted: the
+* value of rank ceil(quantile * count) in ascending order, as approximated
+* by its bucket.
+* @param sketch - sketch to read.
+* @param quantile - between 0 and 1, 0.5 for the median.
+* @return
+* 0 if sketch is NULL or empty, the quantile otherwise.
+*/
+int quantileSketchGetQuantile(QuantileSketch sketch, double quantile);
+
+/**
+* quantileSketchMemoryUsage: returns the bytes of memory used by a sketch.
+* @param sketch - sketch to measure.
+* @return
+* 0 if sketch is NULL, the size of the sketch otherwise.
+*/
+size_t quantileSketchMemoryUsage(QuantileSketch sketch);
+
+#endif
@@ -0,0 +1,207 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "ranking.h"
+
+#define INSERTION_RUN 16
+
+typedef struct RankEntry_t
+{
+    double level;
+    int id;
+} RankEntry;
+
+/** Work of one thread: sort a run, or merge two neighbouring runs */
+typedef struct RankTask_t
+{
+    RankEntry *source;
+    RankEntry *target;
+    int low;
+    int middle;
+    int high;
+    pthread_t thread;
+    bool started;
+} RankTask;
+
+static bool rankIsBefore(const RankEntry *first, const RankEntry *second);
+static void rankMerge(const RankEntry *source, RankEntry *target, int low, int middle, int high);
+static void rankSortRun(RankEntry *entries, RankEntry *buffer, int low, int high);
+static void *rankSortTask(void *task);
+static void *rankMergeTask(void *task);
+static void rankRunTasks(RankTask *tasks, int count, void *(*work)(void *));
+static void rankSetTask(RankTask *task, RankEntry *source, RankEntry *target, int low, int middle, int high);
+
+bool rankIsBefore(const RankEntry *first, const RankEntry *second)
+{
+    if (first->level != second->level)
+    {
+        return first->level > second->level;
+    }
+    return first->id < second->id;
+}
+
+/** Merges the sorted runs [low, middle) and [middle, high) of source into target */
+void rankMerge(const RankEntry *source, RankEntry *target, int low, int middle, int high)
+{
+    int left = low, right = middle;
+    for (int i = low; i < high; i++)
+    {
+        if (right >= high || (left < middle && !rankIsBefore(source + right, source + left)))
+        {
+            target[i] = source[left++];
+        }
+        else
+        {
+            target[i] = source[right++];
+        }
+    }
+}
+
+/** Sorts [low, high) of entries, using the same range of buffer */
+void rankSortRun(RankEntry *entries, RankEntry *buffer, int low, int high)
+{
+    for (int start = low; start < high; start += INSERTION_RUN)
+    {
+        int end = start + INSERTION_RUN < high ? start + INSERTION_RUN : high;
+        for (int i = start + 1; i < end; i++)
+        {
+            RankEntry entry = entries[i];
+            int j = i;
+            for (; j > start && rankIsBefore(&entry, entries + j - 1); j--)
+            {
+                entries[j] = entries[j - 1];
+            }
+            entries[j] = entry;
+        }
+    }
+    RankEntry *source = entries, *target = buffer;
+    for (int width = INSERTION_RUN; width < high - low; width *= 2)
+    {
+        for (int start = low; start < high; start += 2 * width)
+        {
+            int middle = start + width < high ? start + width : high;
+            int end = middle + width < high ? middle + width : high;
+            rankMerge(source, target, start, middle, end);
+        }
+        RankEntry *temp = source;
+        source = target;
+        target = temp;
+    }
+    if (source != entries)
+    {
+        memcpy(entries + low, source + low, sizeof(*entries) * (high - low));
+    }
+}
+
+void *rankSortTask(void *task)
+{
+    RankTask *sort = task;
+    rankSortRun(sort->source, sort->target, sort->low, sort->high);
+    return NULL;
+}
+
+void *rankMergeTask(void *task)
+{
+    RankTask *merge = task;
+    rankMerge(merge->source, merge->target, merge->low, merge->middle, merge->high);
+    return NULL;
+}
+
+void rankSetTask(RankTask *task, RankEntry *source, RankEntry *target, int low, int middle, int high)
+{
+    task->source = source;
+    task->target = target;
+    task->low = low;
+    task->middle = middle;
+    task->high = high;
+    task->started = false;
+}
+
+/** Runs every task on its own thread, or in the calling thread if one cannot be started */
+void rankRunTasks(RankTask *tasks, int count, void *(*work)(void *))
+{
+    for (int i = 1; i < count; i++)
+    {
+        tasks[i].started = pthread_create(&tasks[i].thread, NULL, work, tasks + i) == 0;
+    }
+    work(tasks);
+    for (int i = 1; i < count; i++)
+    {
+        if (tasks[i].started)
+        {
+            pthread_join(tasks[i].thread, NULL);
+        }
+        else
+        {
+            work(tasks + i);
+        }
+    }
+}
+
+bool rankingSort(double levels[], int ids[], int size, int workers)
+{
+    if (size < 2)
+    {
+        return true;
+    }
+    RankEntry *entries = malloc(sizeof(*entries) * size);
+    RankEntry *buffer = malloc(sizeof(*buffer) * size);
+    if (entries == NULL || buffer == NULL)
+    {
+        free(entries);
+        free(buffer);
+        return false;
+    }
+    for (int i = 0; i < size; i++)
+    {
+        entries[i].level = levels[i];
+        entries[i].id = ids[i];
+    }
+    int most_workers = size / RANKING_MIN_PLAYERS_PER_WORKER;
+    workers = workers > most_workers ? most_workers : workers;
+    workers = workers > RANKING_MAX_WORKERS ? RANKING_MAX_WORKERS : workers;
+    RankEntry *sorted = entries;
+    if (workers <= 1)
+    {
+        rankSortRun(entries, buffer, 0, size);
+    }
+    else
+    {
+        int bounds[RANKING_MAX_WORKERS + 1];
+        RankTask tasks[RANKING_MAX_WORKERS];
+        for (int i = 0; i <= workers; i++)
+        {
+            bounds[i] = (int)((long long)size * i / workers);
+        }
+        for (int i = 0; i < workers; i++)
+        {
+            rankSetTask(tasks + i, entries, buffer, bounds[i], bounds[i], bounds[i + 1]);
+        }
+        rankRunTasks(tasks, workers, rankSortTask);
+        RankEntry *target = buffer;
+        for (int runs = workers; runs > 1; runs = (runs + 1) / 2)
+        {
+            int merges = 0;
+            for (int i = 0; i < runs; i += 2)
+            {
+                int high = bounds[i + 2 <= runs ? i + 2 : runs];
+                rankSetTask(tasks + merges++, sorted, target, bounds[i], bounds[i + 1], high);
+                bounds[i / 2] = bounds[i];
+            }
+            bounds[merges] = size;
+            rankRunTasks(tasks, merges, rankMergeTask);
+            target = sorted;
+            sorted = tasks[0].target;
+        }
+    }
+    for (int i = 0; i < size; i++)
+    {
+        levels[i] = sorted[i].level;
+        ids[i] = sorted[i].id;
+    }
+    free(entries);
+    free(buffer);
+    return true;
+}
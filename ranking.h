@@ -0,0 +1,34 @@
+#ifndef RANKING_H_
+#define RANKING_H_
+
+#include <stdbool.h>
+
+/**
+* Ranking of players by level, as chessSavePlayersLevels prints them: level
+* descending, ties broken by ascending id.
+* The ranking is a merge sort. With several workers the players are split
+* into one run per worker, the runs are sorted by their own threads, and
+* then merged pairwise, each pair by its own thread, until one run is left.
+*/
+
+/** Most threads a ranking is split over */
+#define RANKING_MAX_WORKERS 64
+
+/** Fewest players each worker of a ranking is given, smaller rankings use less workers */
+#define RANKING_MIN_PLAYERS_PER_WORKER 16384
+
+/**
+* rankingSort: sorts players by level descending, then by id ascending.
+* @param levels - the levels of the players.
+* @param ids - the ids of the players, levels[i] is the level of ids[i].
+*   Sorted along with the levels.
+* @param size - the number of players.
+* @param workers - the most threads to sort with, 1 to sort in the calling
+*   thread only.
+* @return
+* false if an allocation failed, the arrays are unchanged then.
+* true otherwise.
+*/
+bool rankingSort(double levels[], int ids[], int size, int workers);
+
+#endif
@@ -0,0 +1,139 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "snapshot.h"
+
+#define SNAPSHOT_MAGIC "MTMCHESS"
+#define SNAPSHOT_MAGIC_LENGTH 8
+#define SNAPSHOT_BYTE_ORDER 0x01020304
+#define SNAPSHOT_WRITE_CHUNK 1024
+
+typedef int32_t SnapshotInt;
+
+bool snapshotWriteHeader(FILE *file)
+{
+    int header[] = {SNAPSHOT_VERSION, SNAPSHOT_BYTE_ORDER};
+    return snapshotWriteBytes(file, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LENGTH) &&
+           snapshotWriteInts(file, header, 2);
+}
+
+bool snapshotWriteInts(FILE *file, const int *values, int count)
+{
+    SnapshotInt chunk[SNAPSHOT_WRITE_CHUNK];
+    for (int start = 0; start < count; start += SNAPSHOT_WRITE_CHUNK)
+    {
+        int size = count - start < SNAPSHOT_WRITE_CHUNK ? count - start : SNAPSHOT_WRITE_CHUNK;
+        for (int i = 0; i < size; i++)
+        {
+            chunk[i] = values[start + i];
+        }
+        if (fwrite(chunk, sizeof(*chunk), size, file) != (size_t)size)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool snapshotWriteDouble(FILE *file, double value)
+{
+    return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+bool snapshotWriteBytes(FILE *file, const void *bytes, size_t count)
+{
+    return count == 0 || fwrite(bytes, 1, count, file) == count;
+}
+
+bool snapshotReaderOpen(SnapshotReader *reader, const char *path)
+{
+    reader->base = NULL;
+    reader->length = 0;
+    int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0)
+    {
+        return false;
+    }
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || status.st_size <= 0)
+    {
+        close(descriptor);
+        return false;
+    }
+    void *base = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (base == MAP_FAILED)
+    {
+        return false;
+    }
+    reader->base = base;
+    reader->length = status.st_size;
+    reader->position = base;
+    reader->end = reader->position + reader->length;
+    const char *magic = snapshotReadBytes(reader, SNAPSHOT_MAGIC_LENGTH);
+    int header[2];
+    if (magic == NULL || memcmp(magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LENGTH) != 0 ||
+        !snapshotReadInts(reader, header, 2) || header[0] != SNAPSHOT_VERSION ||
+        header[1] != SNAPSHOT_BYTE_ORDER)
+    {
+        snapshotReaderClose(reader);
+        return false;
+    }
+    return true;
+}
+
+void snapshotReaderClose(SnapshotReader *reader)
+{
+    if (reader->base != NULL)
+    {
+        munmap(reader->base, reader->length);
+        reader->base = NULL;
+    }
+}
+
+bool snapshotReadInts(SnapshotReader *reader, int *values, int count)
+{
+    if (count < 0)
+    {
+        return false;
+    }
+    const unsigned char *bytes = snapshotReadBytes(reader, sizeof(SnapshotInt) * (size_t)count);
+    if (bytes == NULL)
+    {
+        return false;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        SnapshotInt value;
+        memcpy(&value, bytes + sizeof(value) * i, sizeof(value));
+        values[i] = value;
+    }
+    return true;
+}
+
+bool snapshotReadDouble(SnapshotReader *reader, double *value)
+{
+    const void *bytes = snapshotReadBytes(reader, sizeof(*value));
+    if (bytes == NULL)
+    {
+        return false;
+    }
+    memcpy(value, bytes, sizeof(*value));
+    return true;
+}
+
+const void *snapshotReadBytes(SnapshotReader *reader, size_t count)
+{
+    if (count > (size_t)(reader->end - reader->position))
+    {
+        return NULL;
+    }
+    const void *bytes = reader->position;
+    reader->position += count;
+    return bytes;
+}
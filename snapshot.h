@@ -0,0 +1,124 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+* Binary snapshot files.
+* A snapshot is a header followed by 32 bit integers, doubles and raw
+* bytes, in the byte order of the machine which wrote it. The header holds a
+* magic string, the format version and a byte order mark, and a snapshot
+* whose header does not match the reading machine is rejected.
+* Files are read by mapping them into memory. A reader checks every read
+* against the end of the file, so a cut or corrupt snapshot fails to load
+* instead of being read past its end.
+*
+* Functions:
+* snapshotWriteHeader: writes the header of a snapshot.
+* snapshotWriteInts: writes integers.
+* snapshotWriteDouble: writes a double.
+* snapshotWriteBytes: writes raw bytes.
+* snapshotReaderOpen: maps a snapshot file and checks its header.
+* snapshotReaderClose: unmaps a snapshot file.
+* snapshotReadInts: reads integers.
+* snapshotReadDouble: reads a double.
+* snapshotReadBytes: returns raw bytes of the mapped file.
+*/
+
+/** Version of the snapshot format, raised whenever the layout changes */
+#define SNAPSHOT_VERSION 1
+
+/** A mapped snapshot file and the position of the next read */
+typedef struct SnapshotReader_t
+{
+    void *base;
+    size_t length;
+    const unsigned char *position;
+    const unsigned char *end;
+} SnapshotReader;
+
+/**
+* snapshotWriteHeader: writes the header of a snapshot at the start of a file.
+* @param file - the file to write to.
+* @return
+* false if the write failed, true otherwise.
+*/
+bool snapshotWriteHeader(FILE *file);
+
+/**
+* snapshotWriteInts: writes integers to a snapshot file.
+* @param file - the file to write to.
+* @param values - the integers.
+* @param count - the number of integers.
+* @return
+* false if the write failed, true otherwise.
+*/
+bool snapshotWriteInts(FILE *file, const int *values, int count);
+
+/**
+* snapshotWriteDouble: writes a double to a snapshot file, bit for bit.
+* @param file - the file to write to.
+* @param value - the double.
+* @return
+* false if the write failed, true otherwise.
+*/
+bool snapshotWriteDouble(FILE *file, double value);
+
+/**
+* snapshotWriteBytes: writes raw bytes to a snapshot file.
+* @param file - the file to write to.
+* @param bytes - the bytes.
+* @param count - the number of bytes.
+* @return
+* false if the write failed, true otherwise.
+*/
+bool snapshotWriteBytes(FILE *file, const void *bytes, size_t count);
+
+/**
+* snapshotReaderOpen: maps a snapshot file into memory and reads its header.
+* @param reader - the reader to open.
+* @param path - the path of the file.
+* @return
+* false if the file could not be mapped or its header does not match, the
+*   reader is closed then. true otherwise.
+*/
+bool snapshotReaderOpen(SnapshotReader *reader, const char *path);
+
+/**
+* snapshotReaderClose: unmaps the file of a reader. Bytes returned by
+* snapshotReadBytes are invalid afterwards.
+* @param reader - the reader to close.
+*/
+void snapshotReaderClose(SnapshotReader *reader);
+
+/**
+* snapshotReadInts: reads integers from a snapshot.
+* @param reader - the reader to read from.
+* @param values - where to write the integers.
+* @param count - the number of integers.
+* @return
+* false if the snapshot ends before them, true otherwise.
+*/
+bool snapshotReadInts(SnapshotReader *reader, int *values, int count);
+
+/**
+* snapshotReadDouble: reads a double from a snapshot.
+* @param reader - the reader to read from.
+* @param value - where to write the double.
+* @return
+* false if the snapshot ends before it, true otherwise.
+*/
+bool snapshotReadDouble(SnapshotReader *reader, double *value);
+
+/**
+* snapshotReadBytes: returns raw bytes of a snapshot, inside the mapped file.
+* @param reader - the reader to read from.
+* @param count - the number of bytes.
+* @return
+* NULL if the snapshot ends before them, the first of them otherwise.
+*/
+const void *snapshotReadBytes(SnapshotReader *reader, size_t count);
+
+#endif
@@ -0,0 +1,204 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include "standings.h"
+
+#define STANDINGS_INITIAL_CAPACITY 8
+
+/** Position in the heap of every player of the standings, by player id */
+MAP_TABLE_DEFINE(StandingPositions, standingPositions, int, int)
+
+typedef struct StandingsEntry_t
+{
+    int player_id;
+    Player player;
+} StandingsEntry;
+
+struct standings_t
+{
+    StandingsEntry *entries;
+    StandingPositions positions;
+    int size;
+    int capacity;
+};
+
+static bool standingsIsAhead(StandingsEntry first, StandingsEntry second);
+static void standingsSet(Standings standings, int position, StandingsEntry entry);
+static int standingsSiftUp(Standings standings, int position);
+static void standingsSiftDown(Standings standings, int position);
+
+Standings standingsCreate()
+{
+    Standings standings = malloc(sizeof(*standings));
+    if (standings == NULL)
+    {
+        return NULL;
+    }
+    standings->entries = NULL;
+    standings->positions = standingPositionsCreate();
+    if (standings->positions == NULL)
+    {
+        free(standings);
+        return NULL;
+    }
+    standings->size = 0;
+    standings->capacity = 0;
+    return standings;
+}
+
+Standings standingsBuild(PlayerMap players)
+{
+    Standings standings = standingsCreate();
+    if (standings == NULL)
+    {
+        return NULL;
+    }
+    if (!standingsReserve(standings, playerMapGetSize(players)))
+    {
+        standingsDestroy(standings);
+        return NULL;
+    }
+    MAP_DEFINE_FOREACH(PlayerMap, playerMap, cursor, players)
+    {
+        StandingsEntry entry = {playerMapCursorGetKey(&cursor), playerMapCursorGetData(&cursor)};
+        standingPositionsPut(standings->positions, entry.player_id, standings->size);
+        standings->entries[standings->size++] = entry;
+    }
+    for (int position = standings->size / 2 - 1; position >= 0; position--)
+    {
+        standingsSiftDown(standings, position);
+    }
+    return standings;
+}
+
+void standingsDestroy(Standings standings)
+{
+    if (standings == NULL)
+    {
+        return;
+    }
+    standingPositionsDestroy(standings->positions);
+    free(standings->entries);
+    free(standings);
+}
+
+bool standingsReserve(Standings standings, int size)
+{
+    if (standingPositionsReserve(standings->positions, size) != MAP_SUCCESS)
+    {
+        return false;
+    }
+    if (size <= standings->capacity)
+    {
+        return true;
+    }
+    int capacity = standings->capacity == 0 ? STANDINGS_INITIAL_CAPACITY : standings->capacity;
+    while (capacity < size)
+    {
+        capacity *= 2;
+    }
+    StandingsEntry *entries = realloc(standings->entries, sizeof(*entries) * capacity);
+    if (entries == NULL)
+    {
+        return false;
+    }
+    standings->entries = entries;
+    standings->capacity = capacity;
+    return true;
+}
+
+bool standingsAdd(Standings standings, int player_id, Player player)
+{
+    if (!standingsReserve(standings, standings->size + 1) ||
+        standingPositionsPut(standings->positions, player_id, standings->size) != MAP_SUCCESS)
+    {
+        return false;
+    }
+    StandingsEntry entry = {player_id, player};
+    standings->entries[standings->size++] = entry;
+    standingsSiftUp(standings, standings->size - 1);
+    return true;
+}
+
+void standingsUpdate(Standings standings, int player_id)
+{
+    int *position = standingPositionsFind(standings->positions, player_id);
+    if (position == NULL)
+    {
+        return;
+    }
+    standingsSiftDown(standings, standingsSiftUp(standings, *position));
+}
+
+Player standingsGetLeader(Standings standings, int *player_id)
+{
+    if (standings == NULL || standings->size == 0)
+    {
+        return NULL;
+    }
+    *player_id = standings->entries[0].player_id;
+    return standings->entries[0].player;
+}
+
+size_t standingsMemoryUsage(Standings standings)
+{
+    if (standings == NULL)
+    {
+        return 0;
+    }
+    return sizeof(*standings) + sizeof(*standings->entries) * standings->capacity +
+           standingPositionsMemoryUsage(standings->positions);
+}
+
+bool standingsIsAhead(StandingsEntry first, StandingsEntry second)
+{
+    int players_compare = comparePlayers(first.player, second.player);
+    if (players_compare != 0)
+    {
+        return players_compare > 0;
+    }
+    return first.player_id < second.player_id;
+}
+
+void standingsSet(Standings standings, int position, StandingsEntry entry)
+{
+    standings->entries[position] = entry;
+    *standingPositionsFind(standings->positions, entry.player_id) = position;
+}
+
+int standingsSiftUp(Standings standings, int position)
+{
+    StandingsEntry entry = standings->entries[position];
+    while (position > 0)
+    {
+        int parent = (position - 1) / 2;
+        if (!standingsIsAhead(entry, standings->entries[parent]))
+        {
+            break;
+        }
+        standingsSet(standings, position, standings->entries[parent]);
+        position = parent;
+    }
+    standingsSet(standings, position, entry);
+    return position;
+}
+
+void standingsSiftDown(Standings standings, int position)
+{
+    StandingsEntry entry = standings->entries[position];
+    while (2 * position + 1 < standings->size)
+    {
+        int child = 2 * position + 1;
+        if (child + 1 < standings->size &&
+            standingsIsAhead(standings->entries[child + 1], standings->entries[child]))
+        {
+            child++;
+        }
+        if (!standingsIsAhead(standings->entries[child], entry))
+        {
+            break;
+        }
+        standingsSet(standings, position, standings->entries[child]);
+        position = child;
+    }
+    standingsSet(standings, position, entry);
+}
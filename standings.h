@@ -0,0 +1,88 @@
+#ifndef STANDINGS_H_
+#define STANDINGS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "player.h"
+
+/**
+* Standings of a tournament: a binary heap of its players ordered as
+* endTournament picks a winner - most points, then least loses, then most
+* wins, then smallest id. The leader is always on top, and a player whose
+* stats changed moves up or down in O(log n).
+* The standings keep the position of every player in a table by player id,
+* so moving a player never has to search the heap for it. Only one player
+* may change between two updates: update each player right after its own
+* stats change.
+*/
+
+typedef struct standings_t *Standings;
+
+/**
+* standingsCreate: Allocates new empty standings.
+* @return
+* NULL if the allocation failed, new standings otherwise.
+*/
+Standings standingsCreate();
+
+/**
+* standingsBuild: Allocates standings holding every player of a map, in O(n).
+* @param players - the players to rank.
+* @return
+* NULL if the allocation failed, new standings otherwise.
+*/
+Standings standingsBuild(PlayerMap players);
+
+/**
+* standingsDestroy: Frees the standings. The players are not freed.
+* @param standings - standings to free.
+*/
+void standingsDestroy(Standings standings);
+
+/**
+* standingsReserve: Makes room for a number of players, so that adding them
+* cannot fail.
+* @param standings - standings to grow.
+* @param size - number of players to make room for.
+* @return
+* false if the allocation failed, true otherwise.
+*/
+bool standingsReserve(Standings standings, int size);
+
+/**
+* standingsAdd: Adds a player which is not in the standings yet.
+* @param standings - standings to update.
+* @param player_id - id of the player.
+* @param player - the player.
+* @return
+* false if the allocation failed, true otherwise.
+*/
+bool standingsAdd(Standings standings, int player_id, Player player);
+
+/**
+* standingsUpdate: Moves a player of the standings to its place after its
+* stats changed. Does nothing if the player is not in the standings.
+* @param standings - standings to update.
+* @param player_id - id of the player whose stats changed.
+*/
+void standingsUpdate(Standings standings, int player_id);
+
+/**
+* standingsGetLeader: Returns the leading player.
+* @param standings - standings to read.
+* @param player_id - where to write the id of the leader.
+* @return
+* NULL if the standings are empty, the leading player otherwise.
+*/
+Player standingsGetLeader(Standings standings, int *player_id);
+
+/**
+* standingsMemoryUsage: returns the bytes of memory used by the standings,
+* without the players.
+* @param standings - standings to measure.
+* @return
+* 0 if standings is NULL, the bytes used otherwise.
+*/
+size_t standingsMemoryUsage(Standings standings);
+
+#endif
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test_utilities.h"
+#include "../chessSystem.h"
+#include "../chess_batch.h"
+
+#define STATISTICS_PATH "tests/batch_test_statistics.txt"
+#define SEQUENTIAL_STATISTICS_PATH "tests/batch_test_sequential_statistics.txt"
+#define OPERATIONS 4000
+#define TOURNAMENTS 12
+#define MAX_GAMES 6
+#define PLAYERS 40
+#define BATCH_PLAYERS 9
+#define MAX_BATCH 20
+#define CHECK_PERIOD 200
+
+static int nextRandom(unsigned int *seed, int bound);
+static void drawBatch(unsigned int *seed, GameRecord records[], int n);
+static char *describeChess(ChessSystem chess, char *statistics_path);
+static bool sameChess(ChessSystem first, ChessSystem second);
+static bool testBatchMatchesSequentialGames(void);
+static bool testBatchRejectsBadArguments(void);
+
+int nextRandom(unsigned int *seed, int bound)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return (int)((*seed >> 8) % (unsigned int)bound);
+}
+
+/** Draws games among few players, including bad ids, winners and play times and repeated pairs */
+void drawBatch(unsigned int *seed, GameRecord records[], int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        records[i].first_player = nextRandom(seed, BATCH_PLAYERS);
+        records[i].second_player = nextRandom(seed, BATCH_PLAYERS);
+        records[i].winner = (Winner)nextRandom(seed, 4);
+        records[i].play_time = nextRandom(seed, 50) - 5;
+    }
+}
+
+/** Returns the levels and the tournament statistics of a chess system, as one string to be freed */
+char *describeChess(ChessSystem chess, char *statistics_path)
+{
+    FILE *description = tmpfile();
+    if (description == NULL)
+    {
+        return NULL;
+    }
+    fprintf(description, "levels %d\n", chessSavePlayersLevels(chess, description));
+    fprintf(description, "statistics %d\n", chessSaveTournamentStatistics(chess, statistics_path));
+    FILE *statistics = fopen(statistics_path, "r");
+    if (statistics != NULL)
+    {
+        int character;
+        while ((character = fgetc(statistics)) != EOF)
+        {
+            fputc(character, description);
+        }
+        fclose(statistics);
+        remove(statistics_path);
+    }
+    long length = ftell(description);
+    char *text = malloc(length + 1);
+    if (text != NULL)
+    {
+        rewind(description);
+        text[fread(text, 1, length, description)] = '\0';
+    }
+    fclose(description);
+    return text;
+}
+
+bool sameChess(ChessSystem first, ChessSystem second)
+{
+    char *first_description = describeChess(first, STATISTICS_PATH);
+    char *second_description = describeChess(second, SEQUENTIAL_STATISTICS_PATH);
+    bool same = first_description != NULL && second_description != NULL &&
+                strcmp(first_description, second_description) == 0;
+    free(first_description);
+    free(second_description);
+    return same;
+}
+
+bool testBatchMatchesSequentialGames(void)
+{
+    ChessSystem batched = chessCreate();
+    ChessSystem sequential = chessCreate();
+    ASSERT_TEST(batched != NULL && sequential != NULL);
+    unsigned int seed = 777;
+    GameRecord records[MAX_BATCH];
+    ChessResult per_record[MAX_BATCH];
+    for (int i = 0; i < OPERATIONS; i++)
+    {
+        int tournament_id = nextRandom(&seed, TOURNAMENTS + 1);
+        int operation = nextRandom(&seed, 100);
+        if (operation < 10)
+        {
+            int max_games = nextRandom(&seed, MAX_GAMES) + 1;
+            ASSERT_TEST(chessAddTournament(batched, tournament_id, max_games, "London") ==
+                        chessAddTournament(sequential, tournament_id, max_games, "London"));
+        }
+        else if (operation < 13)
+        {
+            ASSERT_TEST(chessEndTournament(batched, tournament_id) ==
+                        chessEndTournament(sequential, tournament_id));
+        }
+        else if (operation < 17)
+        {
+            int player_id = nextRandom(&seed, PLAYERS) + 1;
+            ASSERT_TEST(chessRemovePlayer(batched, player_id) == chessRemovePlayer(sequential, player_id));
+        }
+        else
+        {
+            int n = nextRandom(&seed, MAX_BATCH + 1);
+            drawBatch(&seed, records, n);
+            ChessResult result = chessAddGames(batched, tournament_id, records, n, per_record);
+            ChessResult first_failure = CHESS_SUCCESS;
+            for (int j = 0; j < n; j++)
+            {
+                ChessResult expected = chessAddGame(sequential, tournament_id, records[j].first_player,
+                                                    records[j].second_player, records[j].winner,
+                                                    records[j].play_time);
+                ASSERT_TEST(per_record[j] == expected);
+                first_failure = first_failure == CHESS_SUCCESS ? expected : first_failure;
+            }
+            ASSERT_TEST(result == first_failure);
+        }
+        if (i % CHECK_PERIOD == 0)
+        {
+            ASSERT_TEST(sameChess(batched, sequential));
+        }
+    }
+    ASSERT_TEST(sameChess(batched, sequential));
+    chessDestroy(batched);
+    chessDestroy(sequential);
+    return true;
+}
+
+bool testBatchRejectsBadArguments(void)
+{
+    ChessResult per_record[1];
+    GameRecord record = {1, 2, FIRST_PLAYER, 10};
+    ASSERT_TEST(chessAddGames(NULL, 1, &record, 1, per_record) == CHESS_NULL_ARGUMENT);
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST(chess != NULL);
+    ASSERT_TEST(chessAddGames(chess, 1, NULL, 1, per_record) == CHESS_NULL_ARGUMENT);
+    ASSERT_TEST(chessAddGames(chess, 1, &record, 1, NULL) == CHESS_NULL_ARGUMENT);
+    ASSERT_TEST(chessAddGames(chess, 1, NULL, 0, NULL) == CHESS_SUCCESS);
+    chessDestroy(chess);
+    return true;
+}
+
+int main(void)
+{
+    int failed = 0;
+    RUN_TEST(testBatchMatchesSequentialGames, "testBatchMatchesSequentialGames", failed);
+    RUN_TEST(testBatchRejectsBadArguments, "testBatchRejectsBadArguments", failed);
+    return failed == 0 ? 0 : 1;
+}
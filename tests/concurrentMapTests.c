@@ -0,0 +1,268 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdlib.h>
+#include "test_utilities.h"
+#include "../mtm_map/concurrent_map.h"
+
+#define MAP_KINDS 2
+#define SHARDS 16
+#define THREADS 8
+#define SHARED_KEYS 4000
+#define PRIVATE_KEYS 50
+#define PRIVATE_BASE 100000
+#define OPERATIONS 100000
+#define VISIT_PERIOD 1000
+#define SEQUENTIAL_KEYS 500
+
+/** A worker thread: its index, its map and weather or not all its checks held */
+typedef struct worker_t
+{
+    int index;
+    ConcurrentMap map;
+    bool passed;
+} Worker;
+
+static MapDataElement copyInt(MapDataElement element);
+static void freeInt(MapDataElement element);
+static int compareInts(MapKeyElement first, MapKeyElement second);
+static unsigned int hashInt(MapKeyElement element);
+static ConcurrentMap createMap(int kind);
+static void addKeys(MapDataElement data, void *context);
+static bool visitPair(MapKeyElement key, MapDataElement data, void *context);
+static bool sharedOperation(ConcurrentMap map, unsigned int *seed, int round);
+static bool privateOperation(ConcurrentMap map, int key, int round);
+static bool runOperations(Worker *worker);
+static void *operationsThread(void *worker);
+static bool testConcurrentMapSequential(void);
+static bool testConcurrentMapThreads(void);
+static bool testConcurrentMapStatisticsBuild(void);
+
+MapDataElement copyInt(MapDataElement element)
+{
+    int *copy = malloc(sizeof(*copy));
+    if (copy != NULL)
+    {
+        *copy = *(int *)element;
+    }
+    return copy;
+}
+
+void freeInt(MapDataElement element)
+{
+    free(element);
+}
+
+int compareInts(MapKeyElement first, MapKeyElement second)
+{
+    int first_key = *(int *)first;
+    int second_key = *(int *)second;
+    return (first_key > second_key) - (first_key < second_key);
+}
+
+unsigned int hashInt(MapKeyElement element)
+{
+    return (unsigned int)*(int *)element;
+}
+
+/** Creates an empty map of each kind: 0 with generic keys, 1 keyed by int */
+ConcurrentMap createMap(int kind)
+{
+    if (kind == 0)
+    {
+        return concurrentMapCreate(copyInt, copyInt, freeInt, freeInt, compareInts, hashInt, SHARDS);
+    }
+    return concurrentMapCreateInt(copyInt, freeInt, SHARDS - 3);
+}
+
+/** Adds SHARED_KEYS to the data, which keeps it equal to its key modulo SHARED_KEYS */
+void addKeys(MapDataElement data, void *context)
+{
+    (void)context;
+    *(int *)data += SHARED_KEYS;
+}
+
+/** Counts the pairs of a visit, setting the count to -1 on data not equal to its key modulo SHARED_KEYS */
+bool visitPair(MapKeyElement key, MapDataElement data, void *context)
+{
+    int *count = context;
+    if (*(int *)data % SHARED_KEYS != *(int *)key % SHARED_KEYS)
+    {
+        *count = -1;
+        return false;
+    }
+    (*count)++;
+    return true;
+}
+
+/** Puts, removes, updates, looks up or visits a random shared key, which every thread changes */
+bool sharedOperation(ConcurrentMap map, unsigned int *seed, int round)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    int key = (int)((*seed >> 8) % SHARED_KEYS);
+    int operation = (int)((*seed >> 20) % 10);
+    if (operation < 3)
+    {
+        ASSERT_TEST(concurrentMapPut(map, &key, &key) == MAP_SUCCESS);
+    }
+    else if (operation < 4)
+    {
+        MapResult result = concurrentMapRemove(map, &key);
+        ASSERT_TEST(result == MAP_SUCCESS || result == MAP_ITEM_DOES_NOT_EXIST);
+    }
+    else if (operation < 6)
+    {
+        MapResult result = concurrentMapUpdate(map, &key, addKeys, NULL);
+        ASSERT_TEST(result == MAP_SUCCESS || result == MAP_ITEM_DOES_NOT_EXIST);
+    }
+    else if (operation < 9)
+    {
+        int *data = concurrentMapGet(map, &key);
+        ASSERT_TEST(data == NULL || *data % SHARED_KEYS == key);
+        freeInt(data);
+        concurrentMapContains(map, &key);
+    }
+    else if (round % VISIT_PERIOD == 0)
+    {
+        int visit_count = 0;
+        ASSERT_TEST(concurrentMapForEach(map, visitPair, &visit_count) == MAP_SUCCESS && visit_count >= 0);
+        ASSERT_TEST(concurrentMapGetSize(map) >= 0);
+    }
+    return true;
+}
+
+/** Puts, updates or removes a key no other thread uses, which must behave as in a sequential map */
+bool privateOperation(ConcurrentMap map, int key, int round)
+{
+    if (round % 3 == 0)
+    {
+        ASSERT_TEST(concurrentMapPut(map, &key, &key) == MAP_SUCCESS);
+        ASSERT_TEST(concurrentMapUpdate(map, &key, addKeys, NULL) == MAP_SUCCESS);
+        int *data = concurrentMapGet(map, &key);
+        ASSERT_TEST(data != NULL && *data == key + SHARED_KEYS);
+        freeInt(data);
+    }
+    else if (round % 3 == 1)
+    {
+        ASSERT_TEST(concurrentMapRemove(map, &key) == MAP_SUCCESS);
+        ASSERT_TEST(!concurrentMapContains(map, &key));
+        ASSERT_TEST(concurrentMapUpdate(map, &key, addKeys, NULL) == MAP_ITEM_DOES_NOT_EXIST);
+        ASSERT_TEST(concurrentMapRemove(map, &key) == MAP_ITEM_DOES_NOT_EXIST);
+    }
+    return true;
+}
+
+bool runOperations(Worker *worker)
+{
+    unsigned int seed = (unsigned int)worker->index;
+    int base = PRIVATE_BASE * worker->index;
+    for (int round = 0; round < OPERATIONS; round++)
+    {
+        ASSERT_TEST(sharedOperation(worker->map, &seed, round));
+        ASSERT_TEST(privateOperation(worker->map, base + round / 3 % PRIVATE_KEYS, round));
+    }
+    return true;
+}
+
+void *operationsThread(void *worker)
+{
+    ((Worker *)worker)->passed = runOperations(worker);
+    return NULL;
+}
+
+bool testConcurrentMapSequential(void)
+{
+    ASSERT_TEST(concurrentMapCreateInt(copyInt, freeInt, 0) == NULL);
+    ASSERT_TEST(concurrentMapCreateInt(NULL, freeInt, SHARDS) == NULL);
+    ASSERT_TEST(concurrentMapGetSize(NULL) == -1);
+    for (int kind = 0; kind < MAP_KINDS; kind++)
+    {
+        ConcurrentMap map = createMap(kind);
+        ASSERT_TEST(map != NULL);
+        for (int key = 0; key < SEQUENTIAL_KEYS; key++)
+        {
+            ASSERT_TEST(concurrentMapPut(map, &key, &key) == MAP_SUCCESS);
+        }
+        ASSERT_TEST(concurrentMapGetSize(map) == SEQUENTIAL_KEYS);
+        int key = 5;
+        ASSERT_TEST(concurrentMapUpdate(map, &key, addKeys, NULL) == MAP_SUCCESS);
+        int *data = concurrentMapGet(map, &key);
+        ASSERT_TEST(data != NULL && *data == key + SHARED_KEYS);
+        freeInt(data);
+        ASSERT_TEST(concurrentMapRemove(map, &key) == MAP_SUCCESS);
+        ASSERT_TEST(!concurrentMapContains(map, &key) && concurrentMapGet(map, &key) == NULL);
+        ASSERT_TEST(concurrentMapUpdate(map, &key, addKeys, NULL) == MAP_ITEM_DOES_NOT_EXIST);
+        ASSERT_TEST(concurrentMapPut(map, NULL, &key) == MAP_NULL_ARGUMENT);
+        int visit_count = 0;
+        ASSERT_TEST(concurrentMapForEach(map, visitPair, &visit_count) == MAP_SUCCESS);
+        ASSERT_TEST(visit_count == SEQUENTIAL_KEYS - 1);
+        ASSERT_TEST(concurrentMapClear(map) == MAP_SUCCESS && concurrentMapGetSize(map) == 0);
+        concurrentMapDestroy(map);
+    }
+    return true;
+}
+
+bool testConcurrentMapThreads(void)
+{
+    for (int kind = 0; kind < MAP_KINDS; kind++)
+    {
+        ConcurrentMap map = createMap(kind);
+        ASSERT_TEST(map != NULL);
+        Worker workers[THREADS];
+        pthread_t threads[THREADS];
+        for (int i = 0; i < THREADS; i++)
+        {
+            workers[i] = (Worker){i + 1, map, false};
+            ASSERT_TEST(pthread_create(&threads[i], NULL, operationsThread, &workers[i]) == 0);
+        }
+        for (int i = 0; i < THREADS; i++)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        for (int i = 0; i < THREADS; i++)
+        {
+            ASSERT_TEST(workers[i].passed);
+        }
+        int size = 0;
+        for (int key = 0; key < SHARED_KEYS; key++)
+        {
+            size += concurrentMapContains(map, &key);
+        }
+        for (int i = 1; i <= THREADS; i++)
+        {
+            for (int key = PRIVATE_BASE * i; key < PRIVATE_BASE * i + PRIVATE_KEYS; key++)
+            {
+                size += concurrentMapContains(map, &key);
+            }
+        }
+        ASSERT_TEST(size == concurrentMapGetSize(map));
+        int visit_count = 0;
+        ASSERT_TEST(concurrentMapForEach(map, visitPair, &visit_count) == MAP_SUCCESS && visit_count == size);
+        concurrentMapDestroy(map);
+    }
+    return true;
+}
+
+/** The statistics build locks every lookup for writing, this checks the flag reached map.c too */
+bool testConcurrentMapStatisticsBuild(void)
+{
+    Map map = mapCreateInt(copyInt, freeInt);
+    ASSERT_TEST(map != NULL);
+    MapStatistics statistics;
+#ifdef MAP_STATISTICS
+    ASSERT_TEST(mapGetStatistics(map, &statistics) == MAP_SUCCESS);
+#else
+    ASSERT_TEST(mapGetStatistics(map, &statistics) == MAP_ERROR);
+#endif
+    mapDestroy(map);
+    return true;
+}
+
+int main(void)
+{
+    int failed = 0;
+    RUN_TEST(testConcurrentMapSequential, "testConcurrentMapSequential", failed);
+    RUN_TEST(testConcurrentMapThreads, "testConcurrentMapThreads", failed);
+    RUN_TEST(testConcurrentMapStatisticsBuild, "testConcurrentMapStatisticsBuild", failed);
+    return failed == 0 ? 0 : 1;
+}
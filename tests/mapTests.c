@@ -0,0 +1,250 @@
+#include <stdlib.h>
+#include "test_utilities.h"
+#include "../mtm_map/map.h"
+
+#define MAP_KINDS 3
+#define KEYS 5000
+#define RANGE_LOW 1000
+#define RANGE_HIGH 1500
+
+static MapKeyElement copyInt(MapKeyElement element);
+static void freeInt(MapKeyElement element);
+static int compareInts(MapKeyElement first, MapKeyElement second);
+static Map createMap(int kind);
+static bool fillMap(Map map);
+static bool testMapRoundTrip(void);
+static bool testMapIteration(void);
+static bool testMapCursor(void);
+static bool testMapRange(void);
+static bool testMapSnapshotIsolation(void);
+
+MapKeyElement copyInt(MapKeyElement element)
+{
+    int *copy = malloc(sizeof(*copy));
+    if (copy != NULL)
+    {
+        *copy = *(int *)element;
+    }
+    return copy;
+}
+
+void freeInt(MapKeyElement element)
+{
+    free(element);
+}
+
+int compareInts(MapKeyElement first, MapKeyElement second)
+{
+    return *(int *)first - *(int *)second;
+}
+
+/** Creates an empty map of each kind: 0 a tree map, 1 an int map, 2 an inline map */
+Map createMap(int kind)
+{
+    if (kind == 0)
+    {
+        return mapCreate(copyInt, copyInt, freeInt, freeInt, compareInts);
+    }
+    if (kind == 1)
+    {
+        return mapCreateInt(copyInt, freeInt);
+    }
+    return mapCreateInline(copyInt, freeInt, compareInts, sizeof(int));
+}
+
+/** Puts the even keys below 2 * KEYS out of order, each paired with three times itself */
+bool fillMap(Map map)
+{
+    for (int i = 0; i < KEYS; i++)
+    {
+        int key = (int)((i * 7919L) % KEYS) * 2;
+        int data = key * 3;
+        if (mapPut(map, &key, &data) != MAP_SUCCESS)
+        {
+            return false;
+        }
+    }
+    return mapGetSize(map) == KEYS;
+}
+
+bool testMapRoundTrip(void)
+{
+    for (int kind = 0; kind < MAP_KINDS; kind++)
+    {
+        Map map = createMap(kind);
+        ASSERT_TEST(map != NULL);
+        ASSERT_TEST(fillMap(map));
+        for (int key = 0; key < 2 * KEYS; key++)
+        {
+            int *data = mapGet(map, &key);
+            ASSERT_TEST(mapContains(map, &key) == (key % 2 == 0));
+            ASSERT_TEST(key % 2 == 0 ? data != NULL && *data == key * 3 : data == NULL);
+        }
+        for (int key = 0; key < 2 * KEYS; key += 4)
+        {
+            int data = -key;
+            ASSERT_TEST(mapPut(map, &key, &data) == MAP_SUCCESS);
+        }
+        for (int key = 2; key < 2 * KEYS; key += 4)
+        {
+            ASSERT_TEST(mapRemove(map, &key) == MAP_SUCCESS);
+            ASSERT_TEST(mapRemove(map, &key) == MAP_ITEM_DOES_NOT_EXIST);
+        }
+        ASSERT_TEST(mapGetSize(map) == KEYS / 2);
+        for (int key = 0; key < 2 * KEYS; key += 2)
+        {
+            int *data = mapGet(map, &key);
+            ASSERT_TEST(key % 4 == 0 ? data != NULL && *data == -key : data == NULL);
+        }
+        Map copy = mapCopy(map);
+        ASSERT_TEST(copy != NULL && mapGetSize(copy) == KEYS / 2);
+        ASSERT_TEST(mapClear(map) == MAP_SUCCESS && mapGetSize(map) == 0);
+        for (int key = 0; key < 2 * KEYS; key += 4)
+        {
+            int *data = mapGet(copy, &key);
+            ASSERT_TEST(data != NULL && *data == -key);
+        }
+        mapDestroy(copy);
+        mapDestroy(map);
+    }
+    return true;
+}
+
+bool testMapIteration(void)
+{
+    for (int kind = 0; kind < MAP_KINDS; kind++)
+    {
+        Map map = createMap(kind);
+        ASSERT_TEST(map != NULL && fillMap(map));
+        int expected = 0;
+        MAP_FOREACH(int *, key, map)
+        {
+            bool in_order = *key == expected;
+            freeInt(key);
+            ASSERT_TEST(in_order);
+            expected += 2;
+        }
+        ASSERT_TEST(expected == 2 * KEYS);
+        mapDestroy(map);
+    }
+    return true;
+}
+
+bool testMapCursor(void)
+{
+    for (int kind = 0; kind < MAP_KINDS; kind++)
+    {
+        Map map = createMap(kind);
+        ASSERT_TEST(map != NULL);
+        MapCursor cursor = mapCursorFirst(map);
+        ASSERT_TEST(!mapCursorIsValid(&cursor));
+        ASSERT_TEST(fillMap(map));
+        int expected = 0;
+        for (cursor = mapCursorFirst(map); mapCursorIsValid(&cursor); mapCursorNext(&cursor))
+        {
+            ASSERT_TEST(*(int *)mapCursorGetKey(&cursor) == expected);
+            ASSERT_TEST(*(int *)mapCursorGetData(&cursor) == expected * 3);
+            expected += 2;
+        }
+        ASSERT_TEST(expected == 2 * KEYS);
+        ASSERT_TEST(mapCursorGetKey(&cursor) == NULL && mapCursorGetData(&cursor) == NULL);
+        for (cursor = mapCursorFirst(map); mapCursorIsValid(&cursor); mapCursorNext(&cursor))
+        {
+            *(int *)mapCursorGetData(&cursor) += 1;
+        }
+        int key = 10;
+        int *data = mapGet(map, &key);
+        ASSERT_TEST(data != NULL && *data == 31);
+        mapDestroy(map);
+    }
+    return true;
+}
+
+bool testMapRange(void)
+{
+    for (int kind = 0; kind < MAP_KINDS; kind++)
+    {
+        Map map = createMap(kind);
+        ASSERT_TEST(map != NULL && fillMap(map));
+        int absent = RANGE_LOW + 1;
+        MapCursor cursor = mapCursorLowerBound(map, &absent);
+        ASSERT_TEST(mapCursorIsValid(&cursor) && *(int *)mapCursorGetKey(&cursor) == RANGE_LOW + 2);
+        int past_end = 2 * KEYS;
+        cursor = mapCursorLowerBound(map, &past_end);
+        ASSERT_TEST(!mapCursorIsValid(&cursor));
+        int low = RANGE_LOW;
+        int high = RANGE_HIGH;
+        int expected = RANGE_LOW;
+        for (cursor = mapCursorRange(map, &low, &high); mapCursorIsValid(&cursor); mapCursorNext(&cursor))
+        {
+            ASSERT_TEST(*(int *)mapCursorGetKey(&cursor) == expected);
+            expected += 2;
+        }
+        ASSERT_TEST(expected == RANGE_HIGH);
+        high = low;
+        cursor = mapCursorRange(map, &low, &high);
+        ASSERT_TEST(!mapCursorIsValid(&cursor));
+        mapDestroy(map);
+    }
+    return true;
+}
+
+bool testMapSnapshotIsolation(void)
+{
+    Map int_map = createMap(1);
+    ASSERT_TEST(int_map != NULL && mapSnapshot(int_map) == NULL);
+    mapDestroy(int_map);
+    for (int kind = 0; kind < MAP_KINDS; kind += 2)
+    {
+        Map map = createMap(kind);
+        ASSERT_TEST(map != NULL && fillMap(map));
+        Map snapshot = mapSnapshot(map);
+        ASSERT_TEST(snapshot != NULL && mapGetSize(snapshot) == KEYS);
+        for (int key = 0; key < 2 * KEYS; key += 4)
+        {
+            ASSERT_TEST(mapRemove(map, &key) == MAP_SUCCESS);
+        }
+        for (int key = 2; key < 2 * KEYS; key += 4)
+        {
+            int data = -key;
+            ASSERT_TEST(mapPut(snapshot, &key, &data) == MAP_SUCCESS);
+        }
+        int extra = 2 * KEYS + 1;
+        ASSERT_TEST(mapPut(map, &extra, &extra) == MAP_SUCCESS);
+        ASSERT_TEST(!mapContains(snapshot, &extra));
+        Map second = mapSnapshot(snapshot);
+        ASSERT_TEST(second != NULL);
+        mapDestroy(map);
+        ASSERT_TEST(mapGetSize(snapshot) == KEYS);
+        for (int key = 0; key < 2 * KEYS; key += 2)
+        {
+            int *data = mapGet(snapshot, &key);
+            ASSERT_TEST(data != NULL && *data == (key % 4 == 0 ? key * 3 : -key));
+        }
+        ASSERT_TEST(mapClear(snapshot) == MAP_SUCCESS);
+        mapDestroy(snapshot);
+        ASSERT_TEST(mapGetSize(second) == KEYS);
+        int expected = 0;
+        for (MapCursor cursor = mapCursorFirst(second); mapCursorIsValid(&cursor); mapCursorNext(&cursor))
+        {
+            int data = *(int *)mapCursorGetData(&cursor);
+            ASSERT_TEST(*(int *)mapCursorGetKey(&cursor) == expected);
+            ASSERT_TEST(data == (expected % 4 == 0 ? expected * 3 : -expected));
+            expected += 2;
+        }
+        ASSERT_TEST(expected == 2 * KEYS);
+        mapDestroy(second);
+    }
+    return true;
+}
+
+int main(void)
+{
+    int failed = 0;
+    RUN_TEST(testMapRoundTrip, "testMapRoundTrip", failed);
+    RUN_TEST(testMapIteration, "testMapIteration", failed);
+    RUN_TEST(testMapCursor, "testMapCursor", failed);
+    RUN_TEST(testMapRange, "testMapRange", failed);
+    RUN_TEST(testMapSnapshotIsolation, "testMapSnapshotIsolation", failed);
+    return failed == 0 ? 0 : 1;
+}
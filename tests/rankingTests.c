@@ -0,0 +1,104 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test_utilities.h"
+#include "../ranking.h"
+
+#define PLAYERS (RANKING_MIN_PLAYERS_PER_WORKER * 8 + 123)
+#define LEVEL_VALUES 200
+
+static const int worker_counts[] = {2, 3, 4, 7, RANKING_MAX_WORKERS};
+static const int player_counts[] = {0, 1, 2, 17, RANKING_MIN_PLAYERS_PER_WORKER * 2 + 5, PLAYERS};
+
+static unsigned int nextRandom(unsigned int *seed);
+static void fillPlayers(double levels[], int ids[], int size, unsigned int seed);
+static bool isRanked(const double levels[], const int ids[], int size);
+static bool testRankingSingleWorker(void);
+static bool testRankingWorkersMatchSingleWorker(void);
+
+unsigned int nextRandom(unsigned int *seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return *seed >> 8;
+}
+
+/** Gives the ids 1 to size in shuffled order, and levels with many ties */
+void fillPlayers(double levels[], int ids[], int size, unsigned int seed)
+{
+    for (int i = 0; i < size; i++)
+    {
+        ids[i] = i + 1;
+        levels[i] = (double)((int)(nextRandom(&seed) % LEVEL_VALUES) - LEVEL_VALUES / 2) /
+                    (double)(nextRandom(&seed) % 5 + 1);
+    }
+    for (int i = size - 1; i > 0; i--)
+    {
+        int j = (int)(nextRandom(&seed) % (unsigned int)(i + 1));
+        int id = ids[i];
+        ids[i] = ids[j];
+        ids[j] = id;
+    }
+}
+
+bool isRanked(const double levels[], const int ids[], int size)
+{
+    for (int i = 1; i < size; i++)
+    {
+        if (levels[i - 1] < levels[i] || (levels[i - 1] == levels[i] && ids[i - 1] >= ids[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool testRankingSingleWorker(void)
+{
+    double *levels = malloc(sizeof(*levels) * PLAYERS);
+    int *ids = malloc(sizeof(*ids) * PLAYERS);
+    ASSERT_TEST(levels != NULL && ids != NULL);
+    for (size_t i = 0; i < sizeof(player_counts) / sizeof(*player_counts); i++)
+    {
+        int size = player_counts[i];
+        fillPlayers(levels, ids, size, (unsigned int)size);
+        ASSERT_TEST(rankingSort(levels, ids, size, 1));
+        ASSERT_TEST(isRanked(levels, ids, size));
+    }
+    free(levels);
+    free(ids);
+    return true;
+}
+
+bool testRankingWorkersMatchSingleWorker(void)
+{
+    double *expected_levels = malloc(sizeof(*expected_levels) * PLAYERS);
+    int *expected_ids = malloc(sizeof(*expected_ids) * PLAYERS);
+    double *levels = malloc(sizeof(*levels) * PLAYERS);
+    int *ids = malloc(sizeof(*ids) * PLAYERS);
+    ASSERT_TEST(expected_levels != NULL && expected_ids != NULL && levels != NULL && ids != NULL);
+    for (size_t i = 0; i < sizeof(player_counts) / sizeof(*player_counts); i++)
+    {
+        int size = player_counts[i];
+        fillPlayers(expected_levels, expected_ids, size, (unsigned int)size + 1);
+        ASSERT_TEST(rankingSort(expected_levels, expected_ids, size, 1));
+        for (size_t j = 0; j < sizeof(worker_counts) / sizeof(*worker_counts); j++)
+        {
+            fillPlayers(levels, ids, size, (unsigned int)size + 1);
+            ASSERT_TEST(rankingSort(levels, ids, size, worker_counts[j]));
+            ASSERT_TEST(memcmp(levels, expected_levels, sizeof(*levels) * size) == 0);
+            ASSERT_TEST(memcmp(ids, expected_ids, sizeof(*ids) * size) == 0);
+        }
+    }
+    free(expected_levels);
+    free(expected_ids);
+    free(levels);
+    free(ids);
+    return true;
+}
+
+int main(void)
+{
+    int failed = 0;
+    RUN_TEST(testRankingSingleWorker, "testRankingSingleWorker", failed);
+    RUN_TEST(testRankingWorkersMatchSingleWorker, "testRankingWorkersMatchSingleWorker", failed);
+    return failed == 0 ? 0 : 1;
+}
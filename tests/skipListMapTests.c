@@ -0,0 +1,306 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdlib.h>
+#include "test_utilities.h"
+#include "../mtm_map/skiplist_map.h"
+
+#define THREADS 8
+#define SHARED_KEYS 2000
+#define PRIVATE_KEYS 50
+#define PRIVATE_BASE 100000
+#define OPERATIONS 100000
+#define SCAN_PERIOD 500
+#define SCAN_RANGE 100
+#define SHORT_LIVED_ROUNDS 20
+#define CHURN_OPERATIONS 200000
+#define LIVE_THREAD_MAPS 1500
+
+/** A worker thread: its index, its map and weather or not all its checks held */
+typedef struct worker_t
+{
+    int index;
+    SkipListMap map;
+    bool passed;
+} Worker;
+
+/** Follows a scan: the last key seen, the keys counted so far and when to stop */
+typedef struct scan_t
+{
+    int previous;
+    int count;
+    int stop;
+} Scan;
+
+static pthread_barrier_t live_thread_barrier;
+static SkipListMap live_thread_maps[LIVE_THREAD_MAPS];
+
+static MapDataElement copyInt(MapDataElement element);
+static void freeInt(MapDataElement element);
+static int compareInts(MapKeyElement first, MapKeyElement second);
+static SkipListMap createMap(void);
+static bool visitInOrder(MapKeyElement key, MapDataElement data, void *context);
+static bool sharedOperation(SkipListMap map, unsigned int *seed, int round);
+static bool privateOperation(SkipListMap map, int key, int round);
+static bool runOperations(Worker *worker);
+static void *operationsThread(void *worker);
+static void *shortLivedThread(void *worker);
+static bool putIntoLiveThreadMaps(int offset);
+static void *liveThread(void *worker);
+static bool testSkipListConcurrentOperations(void);
+static bool testSkipListReclamation(void);
+static bool testSkipListDestroyWithLiveThreads(void);
+
+MapDataElement copyInt(MapDataElement element)
+{
+    int *copy = malloc(sizeof(*copy));
+    if (copy != NULL)
+    {
+        *copy = *(int *)element;
+    }
+    return copy;
+}
+
+void freeInt(MapDataElement element)
+{
+    free(element);
+}
+
+int compareInts(MapKeyElement first, MapKeyElement second)
+{
+    int first_key = *(int *)first;
+    int second_key = *(int *)second;
+    return (first_key > second_key) - (first_key < second_key);
+}
+
+SkipListMap createMap(void)
+{
+    return skipListMapCreate(copyInt, copyInt, freeInt, freeInt, compareInts);
+}
+
+/** Counts the pairs of a scan, failing it on a key out of order or data not equal to its key */
+bool visitInOrder(MapKeyElement key, MapDataElement data, void *context)
+{
+    Scan *scan = context;
+    if (*(int *)key <= scan->previous || *(int *)data != *(int *)key)
+    {
+        scan->count = -1;
+        return false;
+    }
+    scan->previous = *(int *)key;
+    scan->count++;
+    return scan->count != scan->stop;
+}
+
+/** Puts, removes, looks up or scans a random shared key, which every thread changes */
+bool sharedOperation(SkipListMap map, unsigned int *seed, int round)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    int key = (int)((*seed >> 8) % SHARED_KEYS);
+    int operation = (int)((*seed >> 20) % 10);
+    if (operation < 3)
+    {
+        ASSERT_TEST(skipListMapPut(map, &key, &key) == MAP_SUCCESS);
+    }
+    else if (operation < 6)
+    {
+        MapResult result = skipListMapRemove(map, &key);
+        ASSERT_TEST(result == MAP_SUCCESS || result == MAP_ITEM_DOES_NOT_EXIST);
+    }
+    else if (operation < 9)
+    {
+        int *data = skipListMapGet(map, &key);
+        ASSERT_TEST(data == NULL || *data == key);
+        freeInt(data);
+    }
+    else if (round % SCAN_PERIOD == 0)
+    {
+        Scan scan = {-1, 0, -1};
+        ASSERT_TEST(skipListMapForEach(map, visitInOrder, &scan) == MAP_SUCCESS && scan.count >= 0);
+        int low = key;
+        int high = key + SCAN_RANGE;
+        Scan range = {low - 1, 0, -1};
+        ASSERT_TEST(skipListMapForEachRange(map, &low, &high, visitInOrder, &range) == MAP_SUCCESS);
+        ASSERT_TEST(range.count >= 0 && range.previous < high);
+    }
+    return true;
+}
+
+/** Puts or removes a key no other thread uses, which must behave as in a sequential map */
+bool privateOperation(SkipListMap map, int key, int round)
+{
+    if (round % 3 == 0)
+    {
+        ASSERT_TEST(skipListMapPut(map, &key, &key) == MAP_SUCCESS);
+        ASSERT_TEST(skipListMapContains(map, &key));
+        int *data = skipListMapGet(map, &key);
+        ASSERT_TEST(data != NULL && *data == key);
+        freeInt(data);
+    }
+    else if (round % 3 == 1)
+    {
+        ASSERT_TEST(skipListMapRemove(map, &key) == MAP_SUCCESS);
+        ASSERT_TEST(!skipListMapContains(map, &key));
+        ASSERT_TEST(skipListMapRemove(map, &key) == MAP_ITEM_DOES_NOT_EXIST);
+    }
+    return true;
+}
+
+bool runOperations(Worker *worker)
+{
+    unsigned int seed = (unsigned int)worker->index;
+    int base = PRIVATE_BASE * worker->index;
+    for (int round = 0; round < OPERATIONS; round++)
+    {
+        ASSERT_TEST(sharedOperation(worker->map, &seed, round));
+        ASSERT_TEST(privateOperation(worker->map, base + round / 3 % PRIVATE_KEYS, round));
+    }
+    return true;
+}
+
+void *operationsThread(void *worker)
+{
+    ((Worker *)worker)->passed = runOperations(worker);
+    return NULL;
+}
+
+/** Registers with the map for two operations and exits, leaving its registration to be reused */
+void *shortLivedThread(void *worker)
+{
+    Worker *short_lived = worker;
+    int key = short_lived->index;
+    short_lived->passed = skipListMapPut(short_lived->map, &key, &key) == MAP_SUCCESS &&
+                          skipListMapRemove(short_lived->map, &key) == MAP_SUCCESS;
+    return NULL;
+}
+
+/** Puts a key into every map, the index of the map plus offset */
+bool putIntoLiveThreadMaps(int offset)
+{
+    for (int i = 0; i < LIVE_THREAD_MAPS; i++)
+    {
+        int key = i + offset;
+        ASSERT_TEST(skipListMapPut(live_thread_maps[i], &key, &key) == MAP_SUCCESS);
+    }
+    return true;
+}
+
+/** Uses every map, waits while the main thread destroys and recreates half of them, then uses them again */
+void *liveThread(void *worker)
+{
+    bool passed = putIntoLiveThreadMaps(0);
+    pthread_barrier_wait(&live_thread_barrier);
+    pthread_barrier_wait(&live_thread_barrier);
+    ((Worker *)worker)->passed = putIntoLiveThreadMaps(1) && passed;
+    return NULL;
+}
+
+bool testSkipListConcurrentOperations(void)
+{
+    SkipListMap map = createMap();
+    ASSERT_TEST(map != NULL);
+    Worker workers[THREADS];
+    pthread_t threads[THREADS];
+    for (int i = 0; i < THREADS; i++)
+    {
+        workers[i] = (Worker){i + 1, map, false};
+        ASSERT_TEST(pthread_create(&threads[i], NULL, operationsThread, &workers[i]) == 0);
+    }
+    for (int i = 0; i < THREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < THREADS; i++)
+    {
+        ASSERT_TEST(workers[i].passed);
+    }
+    int size = 0;
+    for (int key = 0; key < SHARED_KEYS; key++)
+    {
+        size += skipListMapContains(map, &key);
+    }
+    for (int i = 1; i <= THREADS; i++)
+    {
+        for (int key = PRIVATE_BASE * i; key < PRIVATE_BASE * i + PRIVATE_KEYS; key++)
+        {
+            size += skipListMapContains(map, &key);
+        }
+    }
+    ASSERT_TEST(size == skipListMapGetSize(map));
+    Scan scan = {-1, 0, -1};
+    ASSERT_TEST(skipListMapForEach(map, visitInOrder, &scan) == MAP_SUCCESS && scan.count == size);
+    Scan stopped = {-1, 0, 3};
+    ASSERT_TEST(skipListMapForEach(map, visitInOrder, &stopped) == MAP_SUCCESS);
+    ASSERT_TEST(stopped.count == (size < 3 ? size : 3));
+    skipListMapDestroy(map);
+    return true;
+}
+
+bool testSkipListReclamation(void)
+{
+    SkipListMap map = createMap();
+    ASSERT_TEST(map != NULL);
+    Worker workers[THREADS];
+    pthread_t threads[THREADS];
+    for (int round = 0; round < SHORT_LIVED_ROUNDS; round++)
+    {
+        for (int i = 0; i < THREADS; i++)
+        {
+            workers[i] = (Worker){round * THREADS + i, map, false};
+            ASSERT_TEST(pthread_create(&threads[i], NULL, shortLivedThread, &workers[i]) == 0);
+        }
+        for (int i = 0; i < THREADS; i++)
+        {
+            pthread_join(threads[i], NULL);
+            ASSERT_TEST(workers[i].passed);
+        }
+    }
+    ASSERT_TEST(skipListMapGetSize(map) == 0);
+    for (int round = 0; round < CHURN_OPERATIONS; round++)
+    {
+        int key = round % PRIVATE_KEYS;
+        ASSERT_TEST(skipListMapPut(map, &key, &key) == MAP_SUCCESS);
+        ASSERT_TEST(skipListMapRemove(map, &key) == MAP_SUCCESS);
+    }
+    ASSERT_TEST(skipListMapGetSize(map) == 0);
+    skipListMapDestroy(map);
+    return true;
+}
+
+bool testSkipListDestroyWithLiveThreads(void)
+{
+    for (int i = 0; i < LIVE_THREAD_MAPS; i++)
+    {
+        live_thread_maps[i] = createMap();
+        ASSERT_TEST(live_thread_maps[i] != NULL);
+    }
+    ASSERT_TEST(pthread_barrier_init(&live_thread_barrier, NULL, 2) == 0);
+    Worker worker = {0, NULL, false};
+    pthread_t thread;
+    ASSERT_TEST(pthread_create(&thread, NULL, liveThread, &worker) == 0);
+    pthread_barrier_wait(&live_thread_barrier);
+    for (int i = 0; i < LIVE_THREAD_MAPS; i += 2)
+    {
+        skipListMapDestroy(live_thread_maps[i]);
+        live_thread_maps[i] = createMap();
+    }
+    pthread_barrier_wait(&live_thread_barrier);
+    pthread_join(thread, NULL);
+    pthread_barrier_destroy(&live_thread_barrier);
+    ASSERT_TEST(worker.passed);
+    for (int i = 0; i < LIVE_THREAD_MAPS; i++)
+    {
+        ASSERT_TEST(skipListMapGetSize(live_thread_maps[i]) == (i % 2 == 0 ? 1 : 2));
+        skipListMapDestroy(live_thread_maps[i]);
+    }
+    return true;
+}
+
+int main(void)
+{
+    int failed = 0;
+    RUN_TEST(testSkipListConcurrentOperations, "testSkipListConcurrentOperations", failed);
+    RUN_TEST(testSkipListReclamation, "testSkipListReclamation", failed);
+    RUN_TEST(testSkipListDestroyWithLiveThreads, "testSkipListDestroyWithLiveThreads", failed);
+    return failed == 0 ? 0 : 1;
+}
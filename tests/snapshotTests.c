@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test_utilities.h"
+#include "../chessSystem.h"
+#include "../chess_snapshot.h"
+
+#define SNAPSHOT_PATH "tests/snapshot_test.bin"
+#define SECOND_SNAPSHOT_PATH "tests/snapshot_test_second.bin"
+#define STATISTICS_PATH "tests/snapshot_test_statistics.txt"
+#define ROUNDS 20
+#define OPERATIONS 400
+#define TOURNAMENTS 30
+#define PLAYERS 60
+#define LOCATIONS 4
+
+static const char *locations[LOCATIONS] = {"London", "Tel aviv", "Haifa", "Paris"};
+
+static int nextRandom(unsigned int *seed, int bound);
+static ChessResult randomOperation(ChessSystem chess, const int operation[]);
+static void drawOperation(unsigned int *seed, int operation[]);
+static char *describeChess(ChessSystem chess);
+static bool sameFiles(const char *first_path, const char *second_path);
+static bool testSnapshotRoundTrip(void);
+static bool testSnapshotRejectsBadFiles(void);
+
+int nextRandom(unsigned int *seed, int bound)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return (int)((*seed >> 8) % (unsigned int)bound);
+}
+
+void drawOperation(unsigned int *seed, int operation[])
+{
+    operation[0] = nextRandom(seed, 100);
+    operation[1] = nextRandom(seed, TOURNAMENTS) + 1;
+    operation[2] = nextRandom(seed, PLAYERS) + 1;
+    operation[3] = nextRandom(seed, PLAYERS) + 1;
+    operation[4] = nextRandom(seed, 3);
+    operation[5] = nextRandom(seed, 100);
+}
+
+/** Applies an operation drawn by drawOperation, mostly adding games */
+ChessResult randomOperation(ChessSystem chess, const int operation[])
+{
+    if (operation[0] < 5)
+    {
+        return chessAddTournament(chess, operation[1], operation[2] % 8 + 1,
+                                  locations[operation[3] % LOCATIONS]);
+    }
+    if (operation[0] < 88)
+    {
+        return chessAddGame(chess, operation[1], operation[2], operation[3],
+                            (Winner)operation[4], operation[5]);
+    }
+    if (operation[0] < 90)
+    {
+        return chessRemoveTournament(chess, operation[1]);
+    }
+    if (operation[0] < 93)
+    {
+        return chessRemovePlayer(chess, operation[2]);
+    }
+    return chessEndTournament(chess, operation[1]);
+}
+
+/** Returns everything the chess system exports, as one string to be freed */
+char *describeChess(ChessSystem chess)
+{
+    FILE *description = tmpfile();
+    if (description == NULL)
+    {
+        return NULL;
+    }
+    fprintf(description, "levels %d\n", chessSavePlayersLevels(chess, description));
+    for (int player_id = 1; player_id <= PLAYERS; player_id++)
+    {
+        ChessResult result;
+        double average = chessCalculateAveragePlayTime(chess, player_id, &result);
+        fprintf(description, "%d %.17g %d\n", player_id, average, result);
+    }
+    fprintf(description, "statistics %d\n",
+            chessSaveTournamentStatistics(chess, STATISTICS_PATH));
+    FILE *statistics = fopen(STATISTICS_PATH, "r");
+    if (statistics != NULL)
+    {
+        int character;
+        while ((character = fgetc(statistics)) != EOF)
+        {
+            fputc(character, description);
+        }
+        fclose(statistics);
+    }
+    long length = ftell(description);
+    char *text = malloc(length + 1);
+    if (text != NULL)
+    {
+        rewind(description);
+        text[fread(text, 1, length, description)] = '\0';
+    }
+    fclose(description);
+    return text;
+}
+
+bool sameFiles(const char *first_path, const char *second_path)
+{
+    FILE *first = fopen(first_path, "rb");
+    FILE *second = fopen(second_path, "rb");
+    bool same = first != NULL && second != NULL;
+    while (same)
+    {
+        int first_byte = fgetc(first);
+        same = first_byte == fgetc(second);
+        if (first_byte == EOF)
+        {
+            break;
+        }
+    }
+    if (first != NULL)
+    {
+        fclose(first);
+    }
+    if (second != NULL)
+    {
+        fclose(second);
+    }
+    return same;
+}
+
+bool testSnapshotRoundTrip(void)
+{
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST(chess != NULL);
+    unsigned int seed = 777;
+    int operation[6];
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        ASSERT_TEST(chessSaveSnapshot(chess, SNAPSHOT_PATH) == CHESS_SUCCESS);
+        ChessResult result;
+        ChessSystem loaded = chessLoadSnapshot(SNAPSHOT_PATH, &result);
+        ASSERT_TEST(result == CHESS_SUCCESS && loaded != NULL);
+        ASSERT_TEST(chessSaveSnapshot(loaded, SECOND_SNAPSHOT_PATH) == CHESS_SUCCESS);
+        ASSERT_TEST(sameFiles(SNAPSHOT_PATH, SECOND_SNAPSHOT_PATH));
+        char *expected = describeChess(chess);
+        char *actual = describeChess(loaded);
+        ASSERT_TEST(expected != NULL && actual != NULL && strcmp(expected, actual) == 0);
+        free(expected);
+        free(actual);
+        for (int i = 0; i < OPERATIONS; i++)
+        {
+            drawOperation(&seed, operation);
+            ASSERT_TEST(randomOperation(chess, operation) == randomOperation(loaded, operation));
+        }
+        expected = describeChess(chess);
+        actual = describeChess(loaded);
+        ASSERT_TEST(expected != NULL && actual != NULL && strcmp(expected, actual) == 0);
+        free(expected);
+        free(actual);
+        chessDestroy(loaded);
+    }
+    chessDestroy(chess);
+    remove(SNAPSHOT_PATH);
+    remove(SECOND_SNAPSHOT_PATH);
+    remove(STATISTICS_PATH);
+    return true;
+}
+
+bool testSnapshotRejectsBadFiles(void)
+{
+    ChessResult result;
+    ASSERT_TEST(chessLoadSnapshot(NULL, &result) == NULL && result == CHESS_NULL_ARGUMENT);
+    ASSERT_TEST(chessLoadSnapshot("tests/no_such_snapshot.bin", &result) == NULL &&
+                result == CHESS_SAVE_FAILURE);
+    ASSERT_TEST(chessSaveSnapshot(NULL, SNAPSHOT_PATH) == CHESS_NULL_ARGUMENT);
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST(chess != NULL);
+    ASSERT_TEST(chessAddTournament(chess, 1, 4, "London") == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 1, 1, 2, FIRST_PLAYER, 10) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSaveSnapshot(chess, SNAPSHOT_PATH) == CHESS_SUCCESS);
+    chessDestroy(chess);
+    FILE *file = fopen(SNAPSHOT_PATH, "rb");
+    ASSERT_TEST(file != NULL);
+    char bytes[4096];
+    size_t length = fread(bytes, 1, sizeof(bytes), file);
+    fclose(file);
+    ASSERT_TEST(length > 0 && length < sizeof(bytes));
+    file = fopen(SNAPSHOT_PATH, "wb");
+    ASSERT_TEST(file != NULL && fwrite(bytes, 1, length - 1, file) == length - 1);
+    fclose(file);
+    ASSERT_TEST(chessLoadSnapshot(SNAPSHOT_PATH, &result) == NULL && result == CHESS_SAVE_FAILURE);
+    bytes[0] ^= 1;
+    file = fopen(SNAPSHOT_PATH, "wb");
+    ASSERT_TEST(file != NULL && fwrite(bytes, 1, length, file) == length);
+    fclose(file);
+    ASSERT_TEST(chessLoadSnapshot(SNAPSHOT_PATH, &result) == NULL && result == CHESS_SAVE_FAILURE);
+    remove(SNAPSHOT_PATH);
+    return true;
+}
+
+int main(void)
+{
+    int failed = 0;
+    RUN_TEST(testSnapshotRoundTrip, "testSnapshotRoundTrip", failed);
+    RUN_TEST(testSnapshotRejectsBadFiles, "testSnapshotRejectsBadFiles", failed);
+    return failed == 0 ? 0 : 1;
+}
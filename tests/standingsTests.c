@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include "test_utilities.h"
+#include "../standings.h"
+#include "../tournament.h"
+#include "../text_writer.h"
+
+#define PLAYERS 40
+#define OPERATIONS 20000
+#define REMOVE_PERCENT 3
+#define TOURNAMENTS 3000
+#define TOURNAMENT_PLAYERS 40
+#define TOURNAMENT_GAMES 60
+
+static int nextRandom(unsigned int *seed, int bound);
+static bool leaderMatchesScan(Standings standings, PlayerMap players);
+static bool recordGame(Standings standings, PlayerMap players, int player_id, int result);
+static bool testStandingsLeaderAfterGames(void);
+static bool testStandingsBuild(void);
+static int tournamentWinner(Tournament tournament);
+static int scanWinner(Tournament tournament);
+static bool testTournamentWinnerAfterTies(void);
+static bool testTournamentWinnerMatchesScan(void);
+
+int nextRandom(unsigned int *seed, int bound)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return (int)((*seed >> 8) % (unsigned int)bound);
+}
+
+/** Checks the leader against a scan of every player: the best by comparePlayers, then the smallest id */
+bool leaderMatchesScan(Standings standings, PlayerMap players)
+{
+    int best_id = 0;
+    Player best = NULL;
+    MAP_DEFINE_FOREACH(PlayerMap, playerMap, cursor, players)
+    {
+        int player_id = playerMapCursorGetKey(&cursor);
+        Player player = playerMapCursorGetData(&cursor);
+        int compare = best == NULL ? 1 : comparePlayers(player, best);
+        if (compare > 0 || (compare == 0 && player_id < best_id))
+        {
+            best_id = player_id;
+            best = player;
+        }
+    }
+    int leader_id = 0;
+    Player leader = standingsGetLeader(standings, &leader_id);
+    return leader == best && (best == NULL || leader_id == best_id);
+}
+
+/** Adds a win, draw or loss to a player, adding it first if it is new, and updates its place */
+bool recordGame(Standings standings, PlayerMap players, int player_id, int result)
+{
+    Player player = playerMapGet(players, player_id);
+    if (player == NULL)
+    {
+        player = playerCreate();
+        if (player == NULL || playerMapPut(players, player_id, player) != MAP_SUCCESS ||
+            !standingsAdd(standings, player_id, player))
+        {
+            return false;
+        }
+    }
+    playerAddGamesPlayed(player, 1);
+    playerAddWins(player, result == 0 ? 1 : 0);
+    playerAddDraws(player, result == 1 ? 1 : 0);
+    playerAddLoses(player, result == 2 ? 1 : 0);
+    standingsUpdate(standings, player_id);
+    return true;
+}
+
+bool testStandingsLeaderAfterGames(void)
+{
+    PlayerMap players = playerMapCreate();
+    Standings standings = standingsCreate();
+    ASSERT_TEST(players != NULL && standings != NULL);
+    int leader_id = 0;
+    ASSERT_TEST(standingsGetLeader(standings, &leader_id) == NULL);
+    unsigned int seed = 17;
+    for (int i = 0; i < OPERATIONS; i++)
+    {
+        int first_id = nextRandom(&seed, PLAYERS) + 1;
+        int second_id = nextRandom(&seed, PLAYERS) + 1;
+        if (nextRandom(&seed, 100) < REMOVE_PERCENT)
+        {
+            playerReset(playerMapGet(players, first_id));
+            standingsUpdate(standings, first_id);
+        }
+        else if (first_id != second_id)
+        {
+            int result = nextRandom(&seed, 3);
+            ASSERT_TEST(recordGame(standings, players, first_id, result));
+            ASSERT_TEST(recordGame(standings, players, second_id, 2 - result));
+        }
+        ASSERT_TEST(leaderMatchesScan(standings, players));
+    }
+    standingsDestroy(standings);
+    playerMapDestroy(players);
+    return true;
+}
+
+bool testStandingsBuild(void)
+{
+    PlayerMap players = playerMapCreate();
+    Standings scratch = standingsCreate();
+    ASSERT_TEST(players != NULL && scratch != NULL);
+    unsigned int seed = 29;
+    for (int i = 0; i < OPERATIONS / 10; i++)
+    {
+        ASSERT_TEST(recordGame(scratch, players, nextRandom(&seed, PLAYERS) + 1, nextRandom(&seed, 3)));
+    }
+    standingsDestroy(scratch);
+    Standings standings = standingsBuild(players);
+    ASSERT_TEST(standings != NULL);
+    ASSERT_TEST(leaderMatchesScan(standings, players));
+    for (int i = 0; i < OPERATIONS / 10; i++)
+    {
+        ASSERT_TEST(recordGame(standings, players, nextRandom(&seed, PLAYERS) + 1, nextRandom(&seed, 3)));
+        ASSERT_TEST(leaderMatchesScan(standings, players));
+    }
+    standingsDestroy(standings);
+    playerMapDestroy(players);
+    return true;
+}
+
+/** Returns the winner id the statistics of an ended tournament print, -1 on failure */
+int tournamentWinner(Tournament tournament)
+{
+    FILE *file = tmpfile();
+    TextWriter writer = textWriterCreate(file);
+    if (writer == NULL)
+    {
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+        return -1;
+    }
+    printTournamentStatistics(writer, tournament);
+    int winner = -1;
+    if (!textWriterDestroy(writer) || fseek(file, 0, SEEK_SET) != 0 || fscanf(file, "%d", &winner) != 1)
+    {
+        winner = -1;
+    }
+    fclose(file);
+    return winner;
+}
+
+/** Returns the id of the best player of a tournament by comparePlayers, then the smallest id */
+int scanWinner(Tournament tournament)
+{
+    int best_id = -1;
+    Player best = NULL;
+    MAP_DEFINE_FOREACH(PlayerMap, playerMap, cursor, tournamentGetPlayersMap(tournament))
+    {
+        int player_id = playerMapCursorGetKey(&cursor);
+        Player player = playerMapCursorGetData(&cursor);
+        int compare = best == NULL ? 1 : comparePlayers(player, best);
+        if (compare > 0 || (compare == 0 && player_id < best_id))
+        {
+            best_id = player_id;
+            best = player;
+        }
+    }
+    return best_id;
+}
+
+bool testTournamentWinnerAfterTies(void)
+{
+    static const int games[][4] = {
+        {2, 4, SECOND_PLAYER, 89}, {13, 32, FIRST_PLAYER, 53}, {33, 25, DRAW, 47},
+        {18, 32, FIRST_PLAYER, 90}, {17, 4, FIRST_PLAYER, 33}, {28, 16, DRAW, 52}, {33, 30, DRAW, 4}};
+    ChessResult result;
+    Tournament tournament = createTournament(5, "London", &result);
+    ASSERT_TEST(tournament != NULL);
+    for (size_t i = 0; i < sizeof(games) / sizeof(*games); i++)
+    {
+        ASSERT_TEST(tournamentAddGame(tournament, games[i][0], games[i][1],
+                                      (Winner)games[i][2], games[i][3]) == CHESS_SUCCESS);
+    }
+    ASSERT_TEST(endTournament(tournament) == CHESS_SUCCESS);
+    ASSERT_TEST(tournamentWinner(tournament) == 13);
+    destroyTournament(tournament);
+    return true;
+}
+
+bool testTournamentWinnerMatchesScan(void)
+{
+    unsigned int seed = 41;
+    for (int i = 0; i < TOURNAMENTS; i++)
+    {
+        ChessResult result;
+        Tournament tournament = createTournament(nextRandom(&seed, 6) + 1, "London", &result);
+        ASSERT_TEST(tournament != NULL);
+        int games = nextRandom(&seed, TOURNAMENT_GAMES) + 1;
+        for (int game = 0; game < games; game++)
+        {
+            int first_id = nextRandom(&seed, TOURNAMENT_PLAYERS) + 1;
+            int second_id = nextRandom(&seed, TOURNAMENT_PLAYERS) + 1;
+            if (nextRandom(&seed, 100) < REMOVE_PERCENT)
+            {
+                tournamentRemovePlayer(tournament, tournamentGetPlayer(tournament, first_id), first_id, NULL);
+            }
+            else
+            {
+                tournamentAddGame(tournament, first_id, second_id, (Winner)nextRandom(&seed, 3),
+                                  nextRandom(&seed, 100) + 1);
+            }
+        }
+        int expected = scanWinner(tournament);
+        if (endTournament(tournament) == CHESS_SUCCESS)
+        {
+            ASSERT_TEST(tournamentWinner(tournament) == expected);
+        }
+        destroyTournament(tournament);
+    }
+    return true;
+}
+
+int main(void)
+{
+    int failed = 0;
+    RUN_TEST(testStandingsLeaderAfterGames, "testStandingsLeaderAfterGames", failed);
+    RUN_TEST(testStandingsBuild, "testStandingsBuild", failed);
+    RUN_TEST(testTournamentWinnerAfterTies, "testTournamentWinnerAfterTies", failed);
+    RUN_TEST(testTournamentWinnerMatchesScan, "testTournamentWinnerMatchesScan", failed);
+    return failed == 0 ? 0 : 1;
+}
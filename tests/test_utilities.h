@@ -0,0 +1,41 @@
+#ifndef TEST_UTILITIES_H_
+#define TEST_UTILITIES_H_
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+* Checks a condition inside a test function, which must return bool.
+* Prints the failed condition and fails the test if it does not hold.
+* Unlike assert, it is not disabled by NDEBUG.
+*/
+#define ASSERT_TEST(expr)                                                      \
+    do                                                                         \
+    {                                                                          \
+        if (!(expr))                                                           \
+        {                                                                      \
+            printf("\nAssertion failed at %s:%d %s ", __FILE__, __LINE__, #expr); \
+            return false;                                                      \
+        }                                                                      \
+    } while (0)
+
+/**
+* Runs a test function, prints its result and counts it in failed if it
+* failed.
+*/
+#define RUN_TEST(test, name, failed)                                           \
+    do                                                                         \
+    {                                                                          \
+        printf("Running %s ... ", name);                                       \
+        if (test())                                                            \
+        {                                                                      \
+            printf("[OK]\n");                                                  \
+        }                                                                      \
+        else                                                                   \
+        {                                                                      \
+            printf("[Failed]\n");                                              \
+            (failed)++;                                                        \
+        }                                                                      \
+    } while (0)
+
+#endif /* TEST_UTILITIES_H_ */
@@ -0,0 +1,109 @@
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "test_utilities.h"
+#include "../text_writer.h"
+
+#define RANDOM_VALUES 3000000
+#define COMPARE_CHUNK 4096
+
+static const double special_values[] = {
+    0.0, -0.0, 0.005, 0.015, 0.025, 0.125, 0.375, -0.125, -0.001, 0.995, 1.005, 2.675,
+    99.995, 123456.785, 1e15, 9.99999e15, 1e16, 1e17, -1e300, HUGE_VAL, -HUGE_VAL};
+static const int special_ints[] = {0, 1, -1, 10, -100, INT_MAX, INT_MIN};
+
+static bool sameContents(FILE *first, FILE *second);
+static bool testTextWriterMatchesPrintf(void);
+static bool testTextWriterReportsFailedWrites(void);
+
+bool sameContents(FILE *first, FILE *second)
+{
+    char first_chunk[COMPARE_CHUNK];
+    char second_chunk[COMPARE_CHUNK];
+    rewind(first);
+    rewind(second);
+    while (true)
+    {
+        size_t first_length = fread(first_chunk, 1, COMPARE_CHUNK, first);
+        size_t second_length = fread(second_chunk, 1, COMPARE_CHUNK, second);
+        if (first_length != second_length || memcmp(first_chunk, second_chunk, first_length) != 0)
+        {
+            return false;
+        }
+        if (first_length == 0)
+        {
+            return true;
+        }
+    }
+}
+
+bool testTextWriterMatchesPrintf(void)
+{
+    FILE *written = tmpfile();
+    FILE *printed = tmpfile();
+    ASSERT_TEST(written != NULL && printed != NULL);
+    TextWriter writer = textWriterCreate(written);
+    ASSERT_TEST(writer != NULL);
+    for (size_t i = 0; i < sizeof(special_values) / sizeof(*special_values); i++)
+    {
+        textWriterFixed(writer, special_values[i]);
+        textWriterChar(writer, '\n');
+        fprintf(printed, "%.2f\n", special_values[i]);
+    }
+    for (size_t i = 0; i < sizeof(special_ints) / sizeof(*special_ints); i++)
+    {
+        textWriterInt(writer, special_ints[i]);
+        textWriterChar(writer, ' ');
+        fprintf(printed, "%d ", special_ints[i]);
+    }
+    unsigned int seed = 1;
+    for (int i = 0; i < RANDOM_VALUES; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        int numerator = (int)((seed >> 4) % 200001) - 100000;
+        seed = seed * 1103515245u + 12345u;
+        int denominator = i % 5 == 0 ? 800 : (int)((seed >> 8) % 1000) + 1;
+        double value = (double)numerator / denominator;
+        textWriterInt(writer, i);
+        textWriterChar(writer, ' ');
+        textWriterFixed(writer, value);
+        textWriterString(writer, "\n");
+        fprintf(printed, "%d %.2f\n", i, value);
+    }
+    textWriterString(writer, "London");
+    fprintf(printed, "%s", "London");
+    ASSERT_TEST(textWriterDestroy(writer));
+    ASSERT_TEST(sameContents(written, printed));
+    fclose(written);
+    fclose(printed);
+    return true;
+}
+
+bool testTextWriterReportsFailedWrites(void)
+{
+    ASSERT_TEST(textWriterCreate(NULL) == NULL);
+    ASSERT_TEST(!textWriterDestroy(NULL));
+    FILE *read_only = tmpfile();
+    ASSERT_TEST(read_only != NULL);
+    FILE *file = freopen(NULL, "r", read_only);
+    ASSERT_TEST(file != NULL);
+    TextWriter writer = textWriterCreate(file);
+    ASSERT_TEST(writer != NULL);
+    for (int i = 0; i < TEXT_WRITER_BUFFER_SIZE; i++)
+    {
+        textWriterInt(writer, i);
+    }
+    ASSERT_TEST(!textWriterFlush(writer));
+    ASSERT_TEST(!textWriterDestroy(writer));
+    fclose(file);
+    return true;
+}
+
+int main(void)
+{
+    int failed = 0;
+    RUN_TEST(testTextWriterMatchesPrintf, "testTextWriterMatchesPrintf", failed);
+    RUN_TEST(testTextWriterReportsFailedWrites, "testTextWriterReportsFailedWrites", failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include "text_writer.h"
+
+#define INT_TEXT_SIZE 12
+#define FIXED_TEXT_SIZE 32
+#define FIXED_FALLBACK_TEXT_SIZE 400
+#define FIXED_SCALE 100
+#define FIXED_EXACT_LIMIT 1e16
+#define FIXED_PRODUCT_BITS 58
+
+struct text_writer_t
+{
+    FILE *file;
+    char *buffer;
+    int length;
+    bool failed;
+};
+
+static bool textWriterReserve(TextWriter writer, int size);
+static int textWriterDigits(char *end, unsigned long long value);
+
+TextWriter textWriterCreate(FILE *file)
+{
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    TextWriter writer = malloc(sizeof(*writer));
+    if (writer == NULL)
+    {
+        return NULL;
+    }
+    writer->buffer = malloc(TEXT_WRITER_BUFFER_SIZE);
+    if (writer->buffer == NULL)
+    {
+        free(writer);
+        return NULL;
+    }
+    writer->file = file;
+    writer->length = 0;
+    writer->failed = false;
+    return writer;
+}
+
+bool textWriterDestroy(TextWriter writer)
+{
+    if (writer == NULL)
+    {
+        return false;
+    }
+    bool flushed = textWriterFlush(writer);
+    free(writer->buffer);
+    free(writer);
+    return flushed;
+}
+
+bool textWriterFlush(TextWriter writer)
+{
+    if (!writer->failed && writer->length > 0 &&
+        fwrite(writer->buffer, 1, writer->length, writer->file) != (size_t)writer->length)
+    {
+        writer->failed = true;
+    }
+    writer->length = 0;
+    return !writer->failed;
+}
+
+/** Makes room for size bytes in the buffer, returns false once a write failed */
+bool textWriterReserve(TextWriter writer, int size)
+{
+    if (writer->length + size > TEXT_WRITER_BUFFER_SIZE)
+    {
+        textWriterFlush(writer);
+    }
+    return !writer->failed;
+}
+
+/** Writes the decimal digits of a value so that they end right before end, returns their count */
+int textWriterDigits(char *end, unsigned long long value)
+{
+    char *digit = end;
+    do
+    {
+        *--digit = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return (int)(end - digit);
+}
+
+void textWriterInt(TextWriter writer, int value)
+{
+    if (!textWriterReserve(writer, INT_TEXT_SIZE))
+    {
+        return;
+    }
+    unsigned long long magnitude = value < 0 ? -(long long)value : value;
+    if (value < 0)
+    {
+        writer->buffer[writer->length++] = '-';
+    }
+    char text[INT_TEXT_SIZE];
+    int digits = textWriterDigits(text + INT_TEXT_SIZE, magnitude);
+    memcpy(writer->buffer + writer->length, text + INT_TEXT_SIZE - digits, digits);
+    writer->length += digits;
+}
+
+void textWriterFixed(TextWriter writer, double value)
+{
+    if (!textWriterReserve(writer, FIXED_TEXT_SIZE))
+    {
+        return;
+    }
+    double magnitude = value < 0 ? -value : value;
+    /* value * 100 is only exact, and so rounded as printf rounds it, when long double holds its 58 bits */
+    if (LDBL_MANT_DIG < FIXED_PRODUCT_BITS || !(magnitude < FIXED_EXACT_LIMIT))
+    {
+        char text[FIXED_FALLBACK_TEXT_SIZE];
+        snprintf(text, sizeof(text), "%.2f", value);
+        textWriterString(writer, text);
+        return;
+    }
+    long double scaled = (long double)magnitude * FIXED_SCALE;
+    unsigned long long hundredths = (unsigned long long)scaled;
+    long double remainder = scaled - hundredths;
+    if (remainder > 0.5L || (remainder == 0.5L && hundredths % 2 == 1))
+    {
+        hundredths++;
+    }
+    if (signbit(value))
+    {
+        writer->buffer[writer->length++] = '-';
+    }
+    char text[FIXED_TEXT_SIZE];
+    char *end = text + FIXED_TEXT_SIZE;
+    *--end = (char)('0' + hundredths % 10);
+    *--end = (char)('0' + hundredths / 10 % 10);
+    *--end = '.';
+    int length = 3 + textWriterDigits(end, hundredths / FIXED_SCALE);
+    memcpy(writer->buffer + writer->length, text + FIXED_TEXT_SIZE - length, length);
+    writer->length += length;
+}
+
+void textWriterString(TextWriter writer, const char *string)
+{
+    size_t length = strlen(string);
+    while (length > 0)
+    {
+        if (!textWriterReserve(writer, 1))
+        {
+            return;
+        }
+        size_t room = TEXT_WRITER_BUFFER_SIZE - writer->length;
+        size_t chunk = length < room ? length : room;
+        memcpy(writer->buffer + writer->length, string, chunk);
+        writer->length += (int)chunk;
+        string += chunk;
+        length -= chunk;
+    }
+}
+
+void textWriterChar(TextWriter writer, char character)
+{
+    if (textWriterReserve(writer, 1))
+    {
+        writer->buffer[writer->length++] = character;
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef TEXT_WRITER_H_
+#define TEXT_WRITER_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/**
+* Buffered text writer for exports.
+* Numbers are formatted straight into a large buffer, which is written to
+* the file in one fwrite call whenever it fills up. The text is the same
+* fprintf would write with "%d", "%.2f" and "%s", without parsing a format
+* or taking the stream lock for every field.
+* A failed write is remembered: later calls do nothing, and
+* textWriterFlush and textWriterDestroy report it.
+*
+* Functions:
+* textWriterCreate: Allocates a new writer to a file.
+* textWriterDestroy: Flushes the writer and frees it.
+* textWriterFlush: Writes the buffered text to the file.
+* textWriterInt: Writes an integer, as "%d".
+* textWriterFixed: Writes a number with two decimals, as "%.2f".
+* textWriterString: Writes a string, as "%s".
+* textWriterChar: Writes a character.
+*/
+
+/** Bytes of text a writer buffers before writing them to its file */
+#define TEXT_WRITER_BUFFER_SIZE 65536
+
+typedef struct text_writer_t *TextWriter;
+
+/**
+* textWriterCreate: Allocates a new writer to a file.
+* @param file - the file to write to, must stay open until the writer is
+*   destroyed.
+* @return
+* NULL if file is NULL or the allocation failed, a new writer otherwise.
+*/
+TextWriter textWriterCreate(FILE *file);
+
+/**
+* textWriterDestroy: Writes the buffered text to the file and frees the
+* writer. The file is not closed.
+* @param writer - writer to free.
+* @return
+* false if writer is NULL or one of its writes failed, true otherwise.
+*/
+bool textWriterDestroy(TextWriter writer);
+
+/**
+* textWriterFlush: Writes the buffered text to the file.
+* @param writer - writer to flush.
+* @return
+* false if one of the writes of the writer failed, true otherwise.
+*/
+bool textWriterFlush(TextWriter writer);
+
+/**
+* textWriterInt: Writes an integer, as fprintf with "%d" would.
+* @param writer - writer to write to.
+* @param value - the integer.
+*/
+void textWriterInt(TextWriter writer, int value);
+
+/**
+* textWriterFixed: Writes a number with two decimals, as fprintf with "%.2f"
+* would, rounding ties to even.
+* @param writer - writer to write to.
+* @param value - the number.
+*/
+void textWriterFixed(TextWriter writer, double value);
+
+/**
+* textWriterString: Writes a string, as fprintf with "%s" would.
+* @param writer - writer to write to.
+* @param string - the string.
+*/
+void textWriterString(TextWriter writer, const char *string);
+
+/**
+* textWriterChar: Writes a character.
+* @param writer - writer to write to.
+* @param character - the character.
+*/
+void textWriterChar(TextWriter writer, char character);
+
+#endif
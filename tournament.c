@@ -5,33 +5,64 @@
 
 #include "chess_utilities.h"
 #include "tournament.h"
+#include "standings.h"
+#include "quantile_sketch.h"
 #include "./mtm_map/map.h"
 
 #define NO_TIME 0
 #define EMPTY -1
+#define GAME_IDS_INITIAL_CAPACITY 4
+#define TOURNAMENT_SNAPSHOT_FIELDS 6
 
 #define FIRST_UPPER_LETTER 'A'
 #define LAST_UPPER_LETTER 'Z'
 #define FIRST_LOWER_LETTER 'a'
 #define LAST_LOWER_LETTER 'z'
 
-static bool tournamentCheckGameExists(Tournament tournament, int first_player, int second_player);
-static ChessResult tournamentCheckForAddGame(Tournament tournament, int first_player,
- int second_player, Winner winner, int play_time);
 static void tournamentDestroyForAddGame(Player player1, Player player2);
 static void tournamentAddPlayerStats(Player player, int play_time, Winner player_id, Winner winner);
 static ChessResult tournamentCheckIfUsedOrRemovedPlayers(Tournament tournament, Player player1, Player player2);
-static ChessResult tournamentPutNewPlayersForAddGame(Tournament tournament, Player player1, Player player2,
-                                                        int first_player, int second_player);
+static ChessResult tournamentRecordPlayerGame(Tournament tournament, Player player, int player_id,
+                                              Winner player_side, Winner winner, int play_time);
 static ChessResult tournamentCreateNewPlayersForAddGame(Tournament tournament, Player* player1, Player* player2,
                                                         int first_player, int second_player);
+static bool tournamentBuildPairIndex(Tournament tournament);
+static bool tournamentAddPlayerGame(Tournament tournament, int player_id, int game_id);
+static void tournamentUndoPlayerGame(Tournament tournament, int player_id);
+static bool tournamentIndexGame(Tournament tournament, int game_id);
+static char *tournamentLoadLocation(SnapshotReader *reader, int length, ChessResult *result);
+static ChessResult tournamentLoadGames(Tournament tournament, SnapshotReader *reader);
+static ChessResult tournamentLoadPlayers(Tournament tournament, SnapshotReader *reader);
+
+/** Index from the (smaller id, larger id) pair of every game between two players to the game id */
+MAP_TABLE_DEFINE(GamePairIndex, gamePairIndex, unsigned long long, int)
+
+/** The ids of the games a player took part in, in ascending order */
+typedef struct game_ids_t
+{
+    int *ids;
+    int size;
+    int capacity;
+} *GameIds;
+
+static GameIds gameIdsCreate(int capacity);
+static void gameIdsDestroy(GameIds game_ids);
+static GameIds gameIdsCopy(GameIds game_ids);
+static bool gameIdsAdd(GameIds game_ids, int game_id);
+
+/** Index from every player id to the ids of the games of the player */
+MAP_DEFINE(PlayerGamesIndex, playerGamesIndex, int, GameIds, gameIdsCopy, gameIdsDestroy)
 
 struct tournament_t
 {
     int max_games_per_player;
     char *tournament_location;
-    Map games;
-    Map players;
+    GameTable games;
+    GamePairIndex game_pairs;
+    PlayerGamesIndex player_games;
+    PlayerMap players;
+    Standings standings;
+    QuantileSketch play_times;
     int longest_game_time;
     double avg_game_time;
     int winner_id;
@@ -68,11 +99,17 @@ Tournament createTournament(int max_games_per_player, const char *tournament_loc
         return NULL;
     }
     strcpy(tournament->tournament_location, tournament_location);
-    tournament->games = mapCreate(copyDataGame, copyKeyInt, freeGame, freeInt, compareInts);
-    tournament->players = mapCreate(copyDataPlayer, copyKeyInt, freePlayer, freeInt, compareInts);
+    tournament->games = gameTableCreate();
+    tournament->game_pairs = gamePairIndexCreate();
+    tournament->player_games = playerGamesIndexCreate();
+    tournament->players = playerMapCreate();
+    tournament->standings = standingsCreate();
+    tournament->play_times = quantileSketchCreate();
 
     if (strcmp(tournament->tournament_location, tournament_location) != 0 
-    || tournament->games == NULL || tournament->players == NULL)
+    || tournament->games == NULL || tournament->game_pairs == NULL || tournament->player_games == NULL
+    || tournament->players == NULL || tournament->standings == NULL
+    || tournament->play_times == NULL)
     {
         *result = CHESS_OUT_OF_MEMORY;
         destroyTournament(tournament);
@@ -88,26 +125,154 @@ Tournament createTournament(int max_games_per_player, const char *tournament_loc
     return tournament;
 }
 
-bool tournamentCheckGameExists(Tournament tournament, int first_player, int second_player)
+GameIds gameIdsCreate(int capacity)
+{
+    GameIds game_ids = malloc(sizeof(*game_ids));
+    if (game_ids == NULL)
+    {
+        return NULL;
+    }
+    game_ids->ids = malloc(sizeof(*game_ids->ids) * capacity);
+    if (game_ids->ids == NULL)
+    {
+        free(game_ids);
+        return NULL;
+    }
+    game_ids->size = 0;
+    game_ids->capacity = capacity;
+    return game_ids;
+}
+
+void gameIdsDestroy(GameIds game_ids)
+{
+    if (game_ids != NULL)
+    {
+        free(game_ids->ids);
+        free(game_ids);
+    }
+}
+
+GameIds gameIdsCopy(GameIds game_ids)
+{
+    GameIds copy = gameIdsCreate(game_ids->capacity);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    memcpy(copy->ids, game_ids->ids, sizeof(*game_ids->ids) * game_ids->size);
+    copy->size = game_ids->size;
+    return copy;
+}
+
+bool gameIdsAdd(GameIds game_ids, int game_id)
+{
+    if (game_ids->size == game_ids->capacity)
+    {
+        int *ids = realloc(game_ids->ids, sizeof(*ids) * game_ids->capacity * 2);
+        if (ids == NULL)
+        {
+            return false;
+        }
+        game_ids->ids = ids;
+        game_ids->capacity *= 2;
+    }
+    game_ids->ids[game_ids->size++] = game_id;
+    return true;
+}
+
+bool tournamentAddPlayerGame(Tournament tournament, int player_id, int game_id)
+{
+    GameIds game_ids = playerGamesIndexGet(tournament->player_games, player_id);
+    if (game_ids == NULL)
+    {
+        game_ids = gameIdsCreate(GAME_IDS_INITIAL_CAPACITY);
+        if (game_ids == NULL)
+        {
+            return false;
+        }
+        if (playerGamesIndexPut(tournament->player_games, player_id, game_ids) != MAP_SUCCESS)
+        {
+            gameIdsDestroy(game_ids);
+            return false;
+        }
+    }
+    if (!gameIdsAdd(game_ids, game_id))
+    {
+        if (game_ids->size == 0)
+        {
+            playerGamesIndexRemove(tournament->player_games, player_id);
+        }
+        return false;
+    }
+    return true;
+}
+
+/** Takes back the last game tournamentAddPlayerGame added for a player, with the entry it created */
+void tournamentUndoPlayerGame(Tournament tournament, int player_id)
+{
+    GameIds game_ids = playerGamesIndexGet(tournament->player_games, player_id);
+    if (--game_ids->size == 0)
+    {
+        playerGamesIndexRemove(tournament->player_games, player_id);
+    }
+}
+
+/** Adds a game to the pair and player indexes, leaving them unchanged on failure */
+bool tournamentIndexGame(Tournament tournament, int game_id)
+{
+    int first_player = gameGetFirstPlayer(tournament->games, game_id);
+    int second_player = gameGetSecondPlayer(tournament->games, game_id);
+    unsigned long long pair = tournamentPairKey(first_player, second_player);
+    if (gamePairIndexPut(tournament->game_pairs, pair, game_id) != MAP_SUCCESS)
+    {
+        return false;
+    }
+    if (!tournamentAddPlayerGame(tournament, first_player, game_id))
+    {
+        gamePairIndexRemove(tournament->game_pairs, pair, NULL);
+        return false;
+    }
+    if (!tournamentAddPlayerGame(tournament, second_player, game_id))
+    {
+        tournamentUndoPlayerGame(tournament, first_player);
+        gamePairIndexRemove(tournament->game_pairs, pair, NULL);
+        return false;
+    }
+    return true;
+}
+
+unsigned long long tournamentPairKey(int first_player, int second_player)
+{
+    int low = first_player < second_player ? first_player : second_player;
+    int high = first_player < second_player ? second_player : first_player;
+    return ((unsigned long long)(unsigned int)low << 32) | (unsigned int)high;
+}
+
+/** Indexes the pairs of the games, except the games of players who were removed */
+bool tournamentBuildPairIndex(Tournament tournament)
 {
-    MapKeyElement *current;
-    Game current_game;
-    for (current = mapGetFirst(tournament->games);
-         current; current = mapGetNext(tournament->games))
-    {
-        current_game = mapGet(tournament->games, current);
-        if (
-        (gameGetFirstPlayer(current_game) == first_player && 
-        gameGetSecondPlayer(current_game) == second_player) ||
-        (gameGetFirstPlayer(current_game) == second_player &&
-         gameGetSecondPlayer(current_game) == first_player))
+    int games_size = gameTableGetSize(tournament->games);
+    if (gamePairIndexReserve(tournament->game_pairs, games_size) != MAP_SUCCESS)
+    {
+        return false;
+    }
+    for (int game_id = 1; game_id <= games_size; game_id++)
+    {
+        int first_player = gameGetFirstPlayer(tournament->games, game_id);
+        int second_player = gameGetSecondPlayer(tournament->games, game_id);
+        if (first_player > 0 && second_player > 0 &&
+            gamePairIndexPut(tournament->game_pairs, tournamentPairKey(first_player, second_player),
+                             game_id) != MAP_SUCCESS)
         {
-            free(current);
-            return true;
+            return false;
         }
-        free(current);
     }
-    return false;
+    return true;
+}
+
+bool tournamentCheckGameExists(Tournament tournament, int first_player, int second_player)
+{
+    return gamePairIndexContains(tournament->game_pairs, tournamentPairKey(first_player, second_player));
 }
 
 ChessResult tournamentCheckForAddGame(Tournament tournament, int first_player, int second_player,
@@ -186,39 +351,32 @@ ChessResult tournamentCheckIfUsedOrRemovedPlayers(Tournament tournament, Player
     return CHESS_SUCCESS;
 }
 
-ChessResult tournamentPutNewPlayersForAddGame(Tournament tournament, Player player1, Player player2,
- int first_player, int second_player)
+/**
+* Adds the stats of one game to one of its players, stores the player if it
+* is new, and moves it to its place in the standings before the other player
+* of the game changes. A new player is freed if it could not be stored.
+*/
+ChessResult tournamentRecordPlayerGame(Tournament tournament, Player player, int player_id,
+                                       Winner player_side, Winner winner, int play_time)
 {
-    MapResult map_result;
-    if (playerGetGames(player1) == 1 && playerIfWasRemoved(player1) != true)
+    tournamentAddPlayerStats(player, play_time, player_side, winner);
+    if (playerMapContains(tournament->players, player_id))
     {
-        map_result = mapPut(tournament->players,
-         (MapKeyElement)(&first_player), (MapDataElement)(player1));
-        playerDestroy(player1);
-        if (map_result != MAP_SUCCESS)
-        {
-            tournamentDestroyForAddGame(player1, player2);
-            return CHESS_OUT_OF_MEMORY;
-        }
+        standingsUpdate(tournament->standings, player_id);
+        return CHESS_SUCCESS;
     }
-    if (playerGetGames(player2) == 1 && playerIfWasRemoved(player2) != true)
+    if (playerMapPut(tournament->players, player_id, player) != MAP_SUCCESS)
     {
-        map_result = mapPut(tournament->players,
-         (MapKeyElement)(&second_player), (MapDataElement)(player2));
-        playerDestroy(player2);
-        if (map_result != MAP_SUCCESS)
-        {
-            tournamentDestroyForAddGame(player1, player2);
-            return CHESS_OUT_OF_MEMORY;
-        }
+        playerDestroy(player);
+        return CHESS_OUT_OF_MEMORY;
     }
-    return CHESS_SUCCESS;
+    return standingsAdd(tournament->standings, player_id, player) ? CHESS_SUCCESS : CHESS_OUT_OF_MEMORY;
 }
 
 ChessResult tournamentCreateNewPlayersForAddGame(Tournament tournament, Player* player1,
                                                     Player* player2, int first_player, int second_player)
 {
-    if (!mapContains(tournament->players, (MapKeyElement)(&first_player)))
+    if (!playerMapContains(tournament->players, first_player))
     {
         *player1 = playerCreate();
         if (!(*player1))
@@ -227,7 +385,7 @@ ChessResult tournamentCreateNewPlayersForAddGame(Tournament tournament, Player*
         }
         tournament->number_of_players++;
     }
-    if (!mapContains(tournament->players, (MapKeyElement)(&second_player)))
+    if (!playerMapContains(tournament->players, second_player))
     {
         *player2 = playerCreate();
         if (!(*player2))
@@ -250,41 +408,60 @@ ChessResult tournamentAddGame(Tournament tournament, int first_player,
         return result;
     }
 
-    Player player1 = mapGet(tournament->players, (MapKeyElement)(&first_player));
-    Player player2 = mapGet(tournament->players, (MapKeyElement)(&second_player));
+    Player player1 = playerMapGet(tournament->players, first_player);
+    Player player2 = playerMapGet(tournament->players, second_player);
     if(tournamentCheckIfUsedOrRemovedPlayers(tournament,player1,player2) != CHESS_SUCCESS)
     {
         return CHESS_EXCEEDED_GAMES;
     }
-    Game game = gameCreate(first_player, second_player, winner, play_time, &result);
-    if (!game)
+    if (!standingsReserve(tournament->standings, playerMapGetSize(tournament->players) + 2))
+    {
+        return CHESS_OUT_OF_MEMORY;
+    }
+    int next_id;
+    result = gameTableAdd(tournament->games, first_player, second_player, winner, play_time, &next_id);
+    if (result != CHESS_SUCCESS)
     {
         return result;
     }
-    int next_id = mapGetSize(tournament->games) + 1;
-    MapResult map_result = mapPut(tournament->games, (MapKeyElement)(&next_id), (MapDataElement)(game));
-    gameDestroy(game);
-    if (map_result != MAP_SUCCESS)
+    if (!tournamentIndexGame(tournament, next_id))
     {
+        gameTableRemoveLast(tournament->games);
         return CHESS_OUT_OF_MEMORY;
     }
+    quantileSketchAdd(tournament->play_times, play_time);
     tournament->longest_game_time = tournament->longest_game_time > play_time ?
                                      tournament->longest_game_time : play_time;
-    int map_size = mapGetSize(tournament->games);
+    int map_size = gameTableGetSize(tournament->games);
     tournament->avg_game_time = ((tournament->avg_game_time) * (map_size - 1) + play_time) / map_size;
     if(tournamentCreateNewPlayersForAddGame(tournament,&player1,&player2,first_player,second_player) !=
                                             CHESS_SUCCESS)
     {
         return CHESS_OUT_OF_MEMORY;
     }
-    tournamentAddPlayerStats(player1, play_time, FIRST_PLAYER, winner);
-    tournamentAddPlayerStats(player2, play_time, SECOND_PLAYER, winner);
-    if(tournamentPutNewPlayersForAddGame(tournament,player1,player2,first_player,second_player) != 
-                                        CHESS_SUCCESS)
+    result = tournamentRecordPlayerGame(tournament, player1, first_player, FIRST_PLAYER, winner, play_time);
+    if (result != CHESS_SUCCESS)
     {
-        return CHESS_OUT_OF_MEMORY;
+        if (!playerMapContains(tournament->players, second_player))
+        {
+            playerDestroy(player2);
+        }
+        return result;
     }
-    return CHESS_SUCCESS;
+    return tournamentRecordPlayerGame(tournament, player2, second_player, SECOND_PLAYER, winner, play_time);
+}
+
+bool tournamentReserveGames(Tournament tournament, int games_count)
+{
+    if (!tournament || games_count <= 0)
+    {
+        return true;
+    }
+    int games_size = gameTableGetSize(tournament->games) + games_count;
+    return gameTableReserve(tournament->games, games_size) &&
+           gamePairIndexReserve(tournament->game_pairs, gamePairIndexGetSize(tournament->game_pairs) + games_count)
+           == MAP_SUCCESS &&
+           standingsReserve(tournament->standings, playerMapGetSize(tournament->players) + 2 * games_count);
 }
 
 ChessResult endTournament(Tournament tournament)
@@ -297,35 +474,9 @@ ChessResult endTournament(Tournament tournament)
     {
         return CHESS_TOURNAMENT_ENDED;
     }
-    int *current = mapGetFirst(tournament->players);
-    if(current == NULL)
-    {
-        return CHESS_NO_GAMES;
-    }
-    int winner_key = *current;
-    Player winner = mapGet(tournament->players, (MapKeyElement)(current));
-    if (!winner)
-    {
-        return CHESS_NULL_ARGUMENT;
-    }
-    free(current);
-    for (current = mapGetNext(tournament->players); current; current = mapGetNext(tournament->players))
-    {
-        Player temp_player = mapGet(tournament->players, (MapKeyElement)(current));
-        int players_compare = comparePlayers(winner, temp_player);
-        if (players_compare < 0)
-        {
-            winner = temp_player;
-            winner_key = *current;
-        }
-        else if (players_compare == 0)
-        {
-            winner = winner_key < *current ? winner : temp_player;
-            winner_key = winner_key < *current ? winner_key : *current;
-        }
-        free(current);
-    }
-    if(playerGetGames(winner) == 0)
+    int winner_key;
+    Player winner = standingsGetLeader(tournament->standings, &winner_key);
+    if(winner == NULL || playerGetGames(winner) == 0)
     {
         return CHESS_NO_GAMES;
     }
@@ -344,12 +495,22 @@ void destroyTournament(Tournament tournament)
         }
         if (tournament->games != NULL)
         {
-            mapDestroy(tournament->games);
+            gameTableDestroy(tournament->games);
+        }
+        if (tournament->game_pairs != NULL)
+        {
+            gamePairIndexDestroy(tournament->game_pairs);
+        }
+        if (tournament->player_games != NULL)
+        {
+            playerGamesIndexDestroy(tournament->player_games);
         }
         if (tournament->players != NULL)
         {
-            mapDestroy(tournament->players);
+            playerMapDestroy(tournament->players);
         }
+        standingsDestroy(tournament->standings);
+        quantileSketchDestroy(tournament->play_times);
         free(tournament);
     }
 }
@@ -406,24 +567,45 @@ Tournament copyTournament(Tournament tournament)
     new_tournament->winner_id = tournament->winner_id;
     new_tournament->ended = tournament->ended;
     new_tournament->number_of_players = tournament->number_of_players;
-    mapDestroy(new_tournament->games);
-    new_tournament->games = mapCopy(tournament->games);
-    if (!new_tournament->games)
+    quantileSketchDestroy(new_tournament->play_times);
+    new_tournament->play_times = quantileSketchCopy(tournament->play_times);
+    if (!new_tournament->play_times)
+    {
+        destroyTournament(new_tournament);
+        return NULL;
+    }
+    gameTableDestroy(new_tournament->games);
+    new_tournament->games = gameTableCopy(tournament->games);
+    if (!new_tournament->games || !tournamentBuildPairIndex(new_tournament))
+    {
+        destroyTournament(new_tournament);
+        return NULL;
+    }
+    playerGamesIndexDestroy(new_tournament->player_games);
+    new_tournament->player_games = playerGamesIndexCopy(tournament->player_games);
+    if (!new_tournament->player_games)
     {
         destroyTournament(new_tournament);
         return NULL;
     }
-    mapDestroy(new_tournament->players);
-    new_tournament->players = mapCopy(tournament->players);
+    playerMapDestroy(new_tournament->players);
+    new_tournament->players = playerMapCopy(tournament->players);
     if (!new_tournament->players)
     {
         destroyTournament(new_tournament);
         return NULL;
     }
+    standingsDestroy(new_tournament->standings);
+    new_tournament->standings = standingsBuild(new_tournament->players);
+    if (!new_tournament->standings)
+    {
+        destroyTournament(new_tournament);
+        return NULL;
+    }
     return new_tournament;
 }
 
-Map tournamentGetPlayersMap(Tournament tournament)
+PlayerMap tournamentGetPlayersMap(Tournament tournament)
 {
     if (tournament == NULL)
     {
@@ -432,17 +614,26 @@ Map tournamentGetPlayersMap(Tournament tournament)
     return tournament->players;
 }
 
+QuantileSketch tournamentGetPlayTimes(Tournament tournament)
+{
+    if (tournament == NULL)
+    {
+        return NULL;
+    }
+    return tournament->play_times;
+}
+
 Player tournamentGetPlayer(Tournament tournament, int player_id)
 {
     if (!tournament)
     {
         return NULL;
     }
-    Player player = mapGet(tournament->players, (MapKeyElement)(&player_id));
+    Player player = playerMapGet(tournament->players, player_id);
     return player;
 }
 
-ChessResult tournamentRemovePlayer(Tournament tournament, Player player, int player_id)
+ChessResult tournamentRemovePlayer(Tournament tournament, Player player, int player_id, PlayerTotalsMap totals)
 {
     if (!tournament)
     {
@@ -456,36 +647,250 @@ ChessResult tournamentRemovePlayer(Tournament tournament, Player player, int pla
     {
         return CHESS_NULL_ARGUMENT;
     }
-    for (int *current = mapGetFirst(tournament->games); current; current = mapGetNext(tournament->games))
-    {
-        Game game = mapGet(tournament->games, (MapKeyElement)(current));
-        if (!game)
-        {
-            free(current);
-            return CHESS_NULL_ARGUMENT;
-        }
-        ChessResult result = gameRemovePlayer(tournament->players,game, current, player_id);
+    GameIds game_ids = playerGamesIndexGet(tournament->player_games, player_id);
+    for (int i = 0; game_ids != NULL && i < game_ids->size; i++)
+    {
+        int game_id = game_ids->ids[i];
+        int first_player = gameGetFirstPlayer(tournament->games, game_id);
+        int second_player = gameGetSecondPlayer(tournament->games, game_id);
+        bool played = first_player == player_id || second_player == player_id;
+        int opponent_id = first_player == player_id ? second_player : first_player;
+        unsigned long long pair = tournamentPairKey(first_player, second_player);
+        Player opponent = played ? playerMapGet(tournament->players, opponent_id) : NULL;
+        PlayerTotals opponent_totals = played ? playerTotalsMapGet(totals, opponent_id) : NULL;
+        playerTotalsRemove(opponent_totals, opponent);
+        ChessResult result = gameRemovePlayer(tournament->players, tournament->games, game_id, player_id);
+        playerTotalsAdd(opponent_totals, opponent);
         if (result != CHESS_SUCCESS)
         {
-            free(current);
             return result;
         }
-        free(current);
+        if (played)
+        {
+            gamePairIndexRemove(tournament->game_pairs, pair, NULL);
+            standingsUpdate(tournament->standings, opponent_id);
+        }
     }
+    playerGamesIndexRemove(tournament->player_games, player_id);
+    playerTotalsRemove(playerTotalsMapGet(totals, player_id), player);
     playerReset(player);
+    standingsUpdate(tournament->standings, player_id);
     return CHESS_SUCCESS;
 }
 
-ChessResult printTournamentStatistics(FILE *file, Tournament tournament)
+void printTournamentStatistics(TextWriter writer, Tournament tournament)
 {
-    int map_size = mapGetSize(tournament->games);
-    int result = fprintf(file, "%d\n%d\n%.2lf\n%s\n%d\n%d\n",
-            tournament->winner_id, tournament->longest_game_time,
-            tournament->avg_game_time, tournament->tournament_location,
-            map_size, tournament->number_of_players);
-    if(result < 0)
+    int map_size = gameTableGetSize(tournament->games);
+    textWriterInt(writer, tournament->winner_id);
+    textWriterChar(writer, '\n');
+    textWriterInt(writer, tournament->longest_game_time);
+    textWriterChar(writer, '\n');
+    textWriterFixed(writer, tournament->avg_game_time);
+    textWriterChar(writer, '\n');
+    textWriterString(writer, tournament->tournament_location);
+    textWriterChar(writer, '\n');
+    textWriterInt(writer, map_size);
+    textWriterChar(writer, '\n');
+    textWriterInt(writer, tournament->number_of_players);
+    textWriterChar(writer, '\n');
+}
+
+bool tournamentSaveSnapshot(Tournament tournament, FILE *file)
+{
+    int location_length = strlen(tournament->tournament_location);
+    int fields[TOURNAMENT_SNAPSHOT_FIELDS] = {tournament->max_games_per_player, tournament->winner_id,
+                                              tournament->ended, tournament->number_of_players,
+                                              tournament->longest_game_time, location_length};
+    if (!snapshotWriteInts(file, fields, TOURNAMENT_SNAPSHOT_FIELDS) ||
+        !snapshotWriteDouble(file, tournament->avg_game_time) ||
+        !snapshotWriteBytes(file, tournament->tournament_location, location_length) ||
+        !gameTableSaveSnapshot(tournament->games, file))
     {
-        return CHESS_SAVE_FAILURE;
+        return false;
+    }
+    int players_count = playerMapGetSize(tournament->players);
+    if (!snapshotWriteInts(file, &players_count, 1))
+    {
+        return false;
+    }
+    MAP_DEFINE_FOREACH(PlayerMap, playerMap, cursor, tournament->players)
+    {
+        int player_id = playerMapCursorGetKey(&cursor);
+        if (!snapshotWriteInts(file, &player_id, 1) ||
+            !playerSaveSnapshot(playerMapCursorGetData(&cursor), file))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Copies a location out of a snapshot into a new string */
+char *tournamentLoadLocation(SnapshotReader *reader, int length, ChessResult *result)
+{
+    const char *bytes = length < 0 ? NULL : snapshotReadBytes(reader, length);
+    if (bytes == NULL || memchr(bytes, '\0', length) != NULL)
+    {
+        *result = CHESS_SAVE_FAILURE;
+        return NULL;
+    }
+    char *location = malloc(length + 1);
+    if (location == NULL)
+    {
+        *result = CHESS_OUT_OF_MEMORY;
+        return NULL;
+    }
+    memcpy(location, bytes, length);
+    location[length] = '\0';
+    return location;
+}
+
+/** Loads the games of a tournament and rebuilds its indexes and play time sketch from them */
+ChessResult tournamentLoadGames(Tournament tournament, SnapshotReader *reader)
+{
+    ChessResult result = gameTableLoadSnapshot(tournament->games, reader);
+    if (result != CHESS_SUCCESS)
+    {
+        return result;
+    }
+    int games_size = gameTableGetSize(tournament->games);
+    if (gamePairIndexReserve(tournament->game_pairs, games_size) != MAP_SUCCESS)
+    {
+        return CHESS_OUT_OF_MEMORY;
+    }
+    for (int game_id = 1; game_id <= games_size; game_id++)
+    {
+        int first_player = gameGetFirstPlayer(tournament->games, game_id);
+        int second_player = gameGetSecondPlayer(tournament->games, game_id);
+        quantileSketchAdd(tournament->play_times, gameGetPlaytime(tournament->games, game_id));
+        if ((first_player > 0 && !tournamentAddPlayerGame(tournament, first_player, game_id)) ||
+            (second_player > 0 && !tournamentAddPlayerGame(tournament, second_player, game_id)))
+        {
+            return CHESS_OUT_OF_MEMORY;
+        }
+        if (first_player > 0 && second_player > 0 &&
+            gamePairIndexPut(tournament->game_pairs, tournamentPairKey(first_player, second_player),
+                             game_id) != MAP_SUCCESS)
+        {
+            return CHESS_OUT_OF_MEMORY;
+        }
     }
     return CHESS_SUCCESS;
 }
+
+/** Loads the players of a tournament, which were saved in ascending order of their ids */
+ChessResult tournamentLoadPlayers(Tournament tournament, SnapshotReader *reader)
+{
+    int players_count;
+    if (!snapshotReadInts(reader, &players_count, 1) || players_count < 0 ||
+        (size_t)players_count > (size_t)(reader->end - reader->position) / sizeof(int))
+    {
+        return CHESS_SAVE_FAILURE;
+    }
+    if (playerMapReserve(tournament->players, players_count) != MAP_SUCCESS)
+    {
+        return CHESS_OUT_OF_MEMORY;
+    }
+    int previous_id = 0;
+    for (int i = 0; i < players_count; i++)
+    {
+        int player_id;
+        if (!snapshotReadInts(reader, &player_id, 1) || player_id <= previous_id)
+        {
+            return CHESS_SAVE_FAILURE;
+        }
+        previous_id = player_id;
+        Player player = playerCreate();
+        if (player == NULL)
+        {
+            return CHESS_OUT_OF_MEMORY;
+        }
+        if (!playerLoadSnapshot(player, reader) ||
+            playerGetGames(player) > tournament->max_games_per_player)
+        {
+            playerDestroy(player);
+            return CHESS_SAVE_FAILURE;
+        }
+        if (playerMapPut(tournament->players, player_id, player) != MAP_SUCCESS)
+        {
+            playerDestroy(player);
+            return CHESS_OUT_OF_MEMORY;
+        }
+    }
+    MAP_DEFINE_FOREACH(PlayerGamesIndex, playerGamesIndex, cursor, tournament->player_games)
+    {
+        if (!playerMapContains(tournament->players, playerGamesIndexCursorGetKey(&cursor)))
+        {
+            return CHESS_SAVE_FAILURE;
+        }
+    }
+    standingsDestroy(tournament->standings);
+    tournament->standings = standingsBuild(tournament->players);
+    return tournament->standings == NULL ? CHESS_OUT_OF_MEMORY : CHESS_SUCCESS;
+}
+
+Tournament tournamentLoadSnapshot(SnapshotReader *reader, ChessResult *result)
+{
+    int fields[TOURNAMENT_SNAPSHOT_FIELDS];
+    double avg_game_time;
+    if (!snapshotReadInts(reader, fields, TOURNAMENT_SNAPSHOT_FIELDS) ||
+        !snapshotReadDouble(reader, &avg_game_time))
+    {
+        *result = CHESS_SAVE_FAILURE;
+        return NULL;
+    }
+    char *location = tournamentLoadLocation(reader, fields[5], result);
+    if (location == NULL)
+    {
+        return NULL;
+    }
+    Tournament tournament = createTournament(fields[0], location, result);
+    free(location);
+    if (tournament == NULL)
+    {
+        if (*result != CHESS_OUT_OF_MEMORY)
+        {
+            *result = CHESS_SAVE_FAILURE;
+        }
+        return NULL;
+    }
+    *result = tournamentLoadGames(tournament, reader);
+    if (*result == CHESS_SUCCESS)
+    {
+        *result = tournamentLoadPlayers(tournament, reader);
+    }
+    if (*result != CHESS_SUCCESS)
+    {
+        destroyTournament(tournament);
+        return NULL;
+    }
+    tournament->winner_id = fields[1];
+    tournament->ended = fields[2] != 0;
+    tournament->number_of_players = fields[3];
+    tournament->longest_game_time = fields[4];
+    tournament->avg_game_time = avg_game_time;
+    return tournament;
+}
+
+void tournamentMemoryUsage(Tournament tournament, ChessMemoryUsage *usage)
+{
+    usage->tournament = sizeof(*tournament) + quantileSketchMemoryUsage(tournament->play_times);
+    usage->location = strlen(tournament->tournament_location) + 1;
+    usage->games_map = gamePairIndexMemoryUsage(tournament->game_pairs) +
+                       playerGamesIndexMemoryUsage(tournament->player_games);
+    MAP_DEFINE_FOREACH(PlayerGamesIndex, playerGamesIndex, index_cursor, tournament->player_games)
+    {
+        GameIds game_ids = playerGamesIndexCursorGetData(&index_cursor);
+        usage->games_map += sizeof(*game_ids) + sizeof(*game_ids->ids) * game_ids->capacity;
+    }
+    usage->players_map = playerMapMemoryUsage(tournament->players) +
+                         standingsMemoryUsage(tournament->standings);
+    usage->games = gameTableMemoryUsage(tournament->games);
+    usage->players = 0;
+    usage->games_count = gameTableGetSize(tournament->games);
+    usage->players_count = playerMapGetSize(tournament->players);
+    MAP_DEFINE_FOREACH(PlayerMap, playerMap, player_cursor, tournament->players)
+    {
+        usage->players += playerMemoryUsage(playerMapCursorGetData(&player_cursor));
+    }
+}
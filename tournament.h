@@ -5,6 +5,10 @@
 #include "chessSystem.h"
 #include "player.h"
 #include "game.h"
+#include "chess_memory.h"
+#include "quantile_sketch.h"
+#include "text_writer.h"
+#include "snapshot.h"
 
 typedef struct tournament_t *Tournament;
 
@@ -33,6 +37,17 @@ Tournament createTournament(int max_games_per_player, const char *tournament_loc
 ChessResult tournamentAddGame(Tournament tournament, int first_player, int second_player,
                                  Winner winner, int play_time);
 
+/**
+ * tournamentReserveGames: Makes room for a number of new games, so that adding
+ * them does not grow the games map, its indexes or the standings one by one.
+ * @param tournament - the tournament we wish to add games to.
+ * @param games_count - number of games about to be added.
+ * @return
+ *      false if the memory allocation failed, true otherwise. The tournament
+ *      is usable either way.
+ */
+bool tournamentReserveGames(Tournament tournament, int games_count);
+
 /** 
  * endTournament: Calculate the tournament winner and ends the tournament.
  * @param tournament - the tournament we wish to end.
@@ -83,7 +98,54 @@ Tournament copyTournament(Tournament tournament);
 * @return
 * players map. NULL if tournament is NULL.
 */
-Map tournamentGetPlayersMap(Tournament tournament);
+PlayerMap tournamentGetPlayersMap(Tournament tournament);
+
+/**
+* tournamentGetPlayTimes: returns the quantile sketch of the play times of the
+* games of the tournament, kept up to date as games are added.
+* @param tournament - the tournament.
+* @return
+* NULL if tournament is NULL, the sketch of the tournament (not a copy) otherwise.
+*/
+QuantileSketch tournamentGetPlayTimes(Tournament tournament);
+
+/**
+* tournamentPairKey: the key of the pair of players of a game, the same for
+* both orders of the players.
+* @param first_player - id of one player.
+* @param second_player - id of the other player.
+* @return
+* the smaller id in the high 32 bits and the larger id in the low 32 bits.
+*/
+unsigned long long tournamentPairKey(int first_player, int second_player);
+
+/**
+* tournamentCheckGameExists: check if two players already played each other
+* in the tournament, in either order.
+* @param tournament - tournament to check.
+* @param first_player - id of one player.
+* @param second_player - id of the other player.
+* @return true if they played, false if not.
+*/
+bool tournamentCheckGameExists(Tournament tournament, int first_player, int second_player);
+
+/**
+* tournamentCheckForAddGame: checks the arguments of a game against the
+* tournament, as tournamentAddGame does before adding it.
+* @param tournament - tournament the game is for.
+* @param first_player - player 1 id.
+* @param second_player - player 2 id.
+* @param winner - enum for the winner of the game (FIRST/SECOND/DRAW)
+* @param play_time - play time of the game in seconds.
+* @return
+*      CHESS_NULL_ARGUMENT if the tournament is NULL, an id or play_time is 0
+*      or winner is not a Winner.
+*      CHESS_TOURNAMENT_ENDED if the tournament has ended.
+*      CHESS_GAME_ALREADY_EXISTS if the players already played each other.
+*      CHESS_SUCCESS otherwise.
+*/
+ChessResult tournamentCheckForAddGame(Tournament tournament, int first_player, int second_player,
+                                      Winner winner, int play_time);
 
 /**
 * tournamentGetPlayer: get player from players map.
@@ -96,21 +158,55 @@ Player tournamentGetPlayer(Tournament tournament, int player_id);
 
 /**
 * tournamentRemovePlayer: clears player from players map.
+* The stats the removal changes are moved in totals as well: the player's
+* stats are taken off its totals, and the stats of its opponents are updated
+* in theirs.
 * @param tournament - tournament to remove info from.
+* @param player - the player, as tournamentGetPlayer returns it.
 * @param player_id - wanted player`s id.
+* @param totals - the totals of the players across tournaments, or NULL.
 * @return
 * CHESS_NULL_ARGUMENT if one of the agruments are NULL
 * CHESS_INVALID_ID if illegal id.
 * CHESS_SUCCESS if ok.
 * CHESS_PLAYER_NOT_EXIST if the player`s id doesnt exists in the players map.
 */
-ChessResult tournamentRemovePlayer(Tournament tournament, Player player, int player_id);
+ChessResult tournamentRemovePlayer(Tournament tournament, Player player, int player_id, PlayerTotalsMap totals);
 
 /**
 * printTournamentStatistics: print tournament statistics to a file.
-* @param file - file to write to.
+* @param writer - writer to the file, which reports a failed write.
 * @param tournament - tournament to print its statistics.
 */
-ChessResult printTournamentStatistics(FILE *file, Tournament tournament);
+void printTournamentStatistics(TextWriter writer, Tournament tournament);
+
+/**
+* tournamentSaveSnapshot: writes a tournament, its games and its players to a
+* snapshot file. The indexes and standings are not written, they are rebuilt
+* from the games and players when loading.
+* @param tournament - tournament to save.
+* @param file - the snapshot file.
+* @return
+* false if the write failed, true otherwise.
+*/
+bool tournamentSaveSnapshot(Tournament tournament, FILE *file);
+
+/**
+* tournamentLoadSnapshot: reads a tournament written by tournamentSaveSnapshot.
+* @param reader - the snapshot to read from.
+* @param result - enum for the function status.
+* @return
+* A new tournament if successful, NULL otherwise, with result set to
+* CHESS_OUT_OF_MEMORY if an allocation failed and CHESS_SAVE_FAILURE if the
+* snapshot is cut or corrupt.
+*/
+Tournament tournamentLoadSnapshot(SnapshotReader *reader, ChessResult *result);
+
+/**
+* tournamentMemoryUsage: measures the memory used by a tournament.
+* @param tournament - tournament to measure.
+* @param usage - where to write the result.
+*/
+void tournamentMemoryUsage(Tournament tournament, ChessMemoryUsage *usage);
 
 #endif
\ No newline at end of file